@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "bucketstore.hpp"
+
+BucketArena::BucketArena(size_t days_per_block)
+    : per_block_(days_per_block ? days_per_block : 1), used_in_last_(0),
+      free_list_(NULL), free_count_(0), live_(0) {}
+
+BucketArena::~BucketArena() {
+    clear();
+}
+
+bool BucketArena::has_free() const {
+    return free_list_ != NULL || (!blocks_.empty() && used_in_last_ < per_block_);
+}
+
+DayBuckets* BucketArena::alloc() {
+    DayBuckets *b;
+    if (free_list_) {
+        // 1. 优先复用释放过的记录
+        b = free_list_;
+        memcpy(&free_list_, b, sizeof(free_list_));
+        free_count_--;
+    } else {
+        // 2. 从最后一块中切出，用完再分配新块
+        if (blocks_.empty() || used_in_last_ == per_block_) {
+            blocks_.push_back(new DayBuckets[per_block_]);
+            used_in_last_ = 0;
+        }
+        b = blocks_.back() + used_in_last_++;
+    }
+    memset(b, 0, sizeof(*b));
+    live_++;
+    return b;
+}
+
+void BucketArena::release(DayBuckets *b) {
+    static_assert(sizeof(DayBuckets) >= sizeof(DayBuckets *), "record too small for free list link");
+    memcpy(b, &free_list_, sizeof(free_list_));
+    free_list_ = b;
+    free_count_++;
+    live_--;
+}
+
+void BucketArena::clear() {
+    for (DayBuckets *blk : blocks_) delete[] blk;
+    blocks_.clear();
+    used_in_last_ = 0;
+    free_list_ = NULL;
+    free_count_ = 0;
+    live_ = 0;
+}
+
+// —— 常驻窗口与临时文件 ——
+// 临时文件中的一条记录
+struct DetailSpillRecord {
+    int64_t day_start;
+    DayBuckets buckets;
+};
+
+DetailMap::~DetailMap() {
+    if (spill_) fclose(spill_);
+}
+
+bool DetailMap::set_window(size_t max_days, const std::string &spill_template) {
+    if (!spill_) {
+        std::string path = spill_template;
+        int fd = mkstemp(&path[0]);
+        if (fd < 0) return false;
+        unlink(path.c_str());
+        spill_ = fdopen(fd, "w+b");
+        if (!spill_) {
+            close(fd);
+            return false;
+        }
+    }
+    window_ = max_days ? max_days : 1;
+    while (index_.size() > window_) spill_oldest();
+    return true;
+}
+
+void DetailMap::spill_oldest() {
+    auto it = index_.begin();
+    DetailSpillRecord r;
+    memset(&r, 0, sizeof(r));
+    r.day_start = it->first;
+    r.buckets = *it->second;
+    // 写失败时只能丢掉这一天的分桶，每日总数不受影响
+    if (fwrite(&r, sizeof(r), 1, spill_) == 1) spilled_++;
+
+    arena_.release(it->second);
+    index_.erase(it);
+}
+
+DayBuckets& DetailMap::operator[](time_t day_start) {
+    auto it = index_.lower_bound(day_start);
+    if (it == index_.end() || it->first != day_start) {
+        // 先腾出位置再插入，返回的引用在下次调用前一直有效
+        if (spill_ && index_.size() >= window_) {
+            spill_oldest();
+            it = index_.lower_bound(day_start);
+        }
+        it = index_.emplace_hint(it, day_start, arena_.alloc());
+    }
+    return *it->second;
+}
+
+DayBuckets& DetailMap::append(time_t day_start) {
+    auto it = index_.emplace_hint(index_.end(), day_start, (DayBuckets *)NULL);
+    if (!it->second) it->second = arena_.alloc();
+    return *it->second;
+}
+
+const DayBuckets* DetailMap::find(time_t day_start) const {
+    auto it = index_.find(day_start);
+    return it == index_.end() ? NULL : it->second;
+}
+
+void DetailMap::clear() {
+    index_.clear();
+    arena_.clear();
+    if (spill_) {
+        fflush(spill_);
+        if (ftruncate(fileno(spill_), 0) == 0) rewind(spill_);
+        spilled_ = 0;
+    }
+}
+
+// —— 合并读出 ——
+DetailReader::DetailReader(DetailMap &details)
+    : details_(details), it_(details.index_.begin()), spill_(NULL),
+      spill_count_(0), spill_pos_(0), map_len_(0) {
+    if (!details.spill_ || details.spilled_ == 0) return;
+
+    size_t len = details.spilled_ * sizeof(DetailSpillRecord);
+    fflush(details.spill_);
+    void *map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fileno(details.spill_), 0);
+    if (map != MAP_FAILED) {
+        spill_ = (DetailSpillRecord *)map;
+        map_len_ = len;
+    } else {
+        fallback_.resize(len);
+        rewind(details.spill_);
+        if (fread(&fallback_[0], len, 1, details.spill_) != 1) return;
+        fseeko(details.spill_, 0, SEEK_END);
+        spill_ = (DetailSpillRecord *)&fallback_[0];
+    }
+    spill_count_ = details.spilled_;
+
+    // 写出顺序大致就是日期顺序，排序基本是线性的
+    std::sort(spill_, spill_ + spill_count_, [](const DetailSpillRecord &a, const DetailSpillRecord &b) {
+        return a.day_start < b.day_start;
+    });
+}
+
+DetailReader::~DetailReader() {
+    if (map_len_) munmap(spill_, map_len_);
+}
+
+static void add_day_buckets(DayBuckets &out, const DayBuckets &in) {
+    for (int i = 0; i < 12; i++) add_bucket_seconds(out, i, in.sec[i]);
+}
+
+void DetailReader::add_to(time_t day_start, DayBuckets &out) {
+    while (spill_pos_ < spill_count_ && spill_[spill_pos_].day_start < (int64_t)day_start) spill_pos_++;
+    while (spill_pos_ < spill_count_ && spill_[spill_pos_].day_start == (int64_t)day_start) {
+        add_day_buckets(out, spill_[spill_pos_++].buckets);
+    }
+
+    auto end = details_.index_.end();
+    while (it_ != end && it_->first < day_start) ++it_;
+    if (it_ != end && it_->first == day_start) add_day_buckets(out, *it_->second);
+}
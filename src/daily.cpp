@@ -1,23 +1,25 @@
 #include <gtk/gtk.h>
+#include <pthread.h>
+#include <algorithm>
+#include <map>
 
 #include "types.hpp"
 #include "utils.hpp"
 #include "daily.hpp"
 #include "dataprocess.hpp"
+#include "render.hpp"
+#include "detailcache.hpp"
+#include "prefetch.hpp"
+#include "navsched.hpp"
 
 // —— 今日分布绘图 ——
-gboolean draw_today_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
-    cairo_t *cr = gdk_cairo_create(widget->window);
-
-    cairo_set_source_rgb(cr, 1, 1, 1);
+void render_today_dist(cairo_t *cr, const ViewData &v, int w, int h) {
+    set_gray(cr, 1);
     cairo_paint(cr);
 
-    int w = widget->allocation.width;
-    int h = widget->allocation.height;
-
     int left = 50, right = 20, top = 40, bottom = 60;
 
-    cairo_set_source_rgb(cr, 0, 0, 0);
+    set_gray(cr, 0);
     cairo_set_line_width(cr, 2);
 
     cairo_move_to(cr, left, top);
@@ -27,7 +29,7 @@ gboolean draw_today_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data
 
     long maxv = 3600;
     for (int i = 0; i < 12; i++)
-        if (g_stats.view_daily_buckets[i] > maxv) maxv = g_stats.view_daily_buckets[i];
+        if (v.view_daily_buckets[i] > maxv) maxv = v.view_daily_buckets[i];
 
     int chart_w = w - left - right;
     int chart_h = h - top - bottom - 100;
@@ -35,16 +37,20 @@ gboolean draw_today_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data
     double bar_space = chart_w / 12.0;
     double bar_w = bar_space * 0.8;
 
+    // 所有柱子合成一条路径一次填充，文字随后绘制
+    for (int i = 0; i < 12; i++) {
+        double x = left + bar_space * i + (bar_space - bar_w) / 2;
+        double bh = (v.view_daily_buckets[i] / (double)maxv) * chart_h;
+        cairo_rectangle(cr, x, h - bottom - bh, bar_w, bh);
+    }
+    cairo_fill(cr);
+
     for (int i = 0; i < 12; i++) {
         double x = left + bar_space * i + (bar_space - bar_w) / 2;
-        double val = g_stats.view_daily_buckets[i];
+        double val = v.view_daily_buckets[i];
         double bh = (val / (double)maxv) * chart_h;
         double y = h - bottom - bh;
 
-        cairo_set_source_rgb(cr, 0, 0, 0);
-        cairo_rectangle(cr, x, y, bar_w, bh);
-        cairo_fill(cr);
-
         long mins = val / 60;
         if (mins > 0) {
             char buf[32];
@@ -61,25 +67,42 @@ gboolean draw_today_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data
         cairo_show_text(cr, label);
     }
 
+    cairo_set_font_size(cr, 40);
+    cairo_move_to(cr, left + 20, top + 40);
+
+    // 分桶正在后台读取：先画空白坐标轴，读到后整图替换
+    if (v.view_daily_pending) {
+        cairo_show_text(cr, "正在读取当日数据…");
+        return;
+    }
+
     int best = 0;
     for (int i = 1; i < 12; i++)
-        if (g_stats.view_daily_buckets[i] > g_stats.view_daily_buckets[best]) best = i;
+        if (v.view_daily_buckets[i] > v.view_daily_buckets[best]) best = i;
 
     char comment[128];
     snprintf(comment, sizeof(comment),
              "你最常阅读的时间段是 %02d:00-%02d:00", best*2, best*2+2);
-
-    cairo_set_font_size(cr, 40);
-    cairo_move_to(cr, left + 20, top + 40);
     cairo_show_text(cr, comment);
+}
+
+static ChartCache s_today_cache;
 
-    cairo_destroy(cr);
+static void schedule_day_prefetch();
+
+gboolean draw_today_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
+    chart_cache_paint(s_today_cache, widget, event, g_view_data.daily_version, render_today_dist);
+
+    // 首次显示后才能按画布尺寸预渲染相邻日期
+    static bool s_prefetch_started = false;
+    if (!s_prefetch_started) {
+        s_prefetch_started = true;
+        schedule_day_prefetch();
+    }
     return FALSE;
 }
 
-// 辅助函数：更新日视图的文本内容
-void update_daily_view_ui(DailyViewWidgets *dv) {
-    // 1. 更新日期显示
+static void update_daily_date_labels(DailyViewWidgets *dv) {
     struct tm tmv;
     localtime_r(&g_view_daily_ts, &tmv);
     
@@ -89,38 +112,197 @@ void update_daily_view_ui(DailyViewWidgets *dv) {
     
     gtk_label_set_text(GTK_LABEL(dv->label_year), buf_year);
     gtk_label_set_text(GTK_LABEL(dv->label_date), buf_date);
+}
+
+// 辅助函数：更新日视图的文本内容
+void update_daily_view_ui(DailyViewWidgets *dv) {
+    // 1. 更新日期显示
+    update_daily_date_labels(dv);
 
     // 2. 更新总时长显示
     char time_str[64];
-    format_hms(g_stats.view_daily_seconds, time_str, sizeof(time_str));
+    format_hms(g_view_data.view_daily_seconds, time_str, sizeof(time_str));
     
     char total_label_str[128];
     snprintf(total_label_str, sizeof(total_label_str), "当日时长: %s", time_str);
     gtk_label_set_text(GTK_LABEL(dv->label_total_time), total_label_str);
 }
 
+// —— 相邻日期预取 ——
+// 翻页后在空闲时取好前后两天的分桶 (可能需要读快照或重新解析) 并画好图表
+struct DayPrefetch {
+    long buckets[12];
+    unsigned int generation;    // 数据所属的 Stats 版本
+    ChartCache image;
+};
+
+static std::map<time_t, DayPrefetch> s_day_prefetch;
+
+static void drop_day_prefetch(std::map<time_t, DayPrefetch>::iterator it) {
+    chart_cache_reset(it->second.image);
+    s_day_prefetch.erase(it);
+}
+
+static void prefetch_day(time_t day) {
+    if (!g_daily_widgets) return;
+    StatsRef stats = stats_current();
+
+    auto it = s_day_prefetch.find(day);
+    if (it != s_day_prefetch.end()) {
+        if (it->second.generation == stats->generation) return;
+        drop_day_prefetch(it);
+    }
+
+    // 预取在 UI 线程空闲时执行，只取缓存或快照里现成的分桶；
+    // 需要重新解析日志的日子留到真正翻到时再读
+    ViewData v = ViewData();
+    if (!detail_cache_peek(day, v.view_daily_buckets)) return;
+
+    DayPrefetch pf;
+    pf.generation = stats->generation;
+    pf.image = ChartCache();
+    if (!chart_cache_prerender(pf.image, g_daily_widgets->drawing_area, v, render_today_dist)) return;
+    std::copy(v.view_daily_buckets, v.view_daily_buckets + 12, pf.buckets);
+    s_day_prefetch[day] = pf;
+}
+
+static void schedule_day_prefetch() {
+    prefetch_cancel(PREFETCH_DAY);
+
+    time_t prev = add_days(g_view_daily_ts, -1);
+    time_t next = add_days(g_view_daily_ts, 1);
+
+    // 只保留当前日期前后各一天
+    for (auto it = s_day_prefetch.begin(); it != s_day_prefetch.end(); ) {
+        auto cur = it++;
+        if (cur->first != prev && cur->first != next) drop_day_prefetch(cur);
+    }
+
+    prefetch_add(PREFETCH_DAY, [prev]() { prefetch_day(prev); });
+    prefetch_add(PREFETCH_DAY, [next]() { prefetch_day(next); });
+}
+
+// —— 已淘汰日期的后台读取 ——
+// 缓存和快照里都没有的日期只能重新解析日志 (可能要解压整个归档、等加载线程释放 TEMP_LOG_FILE)，
+// 放到后台线程，UI 先显示读取中，取到后在 UI 线程换入。同一时间只读一天
+struct DayLoadJob {
+    time_t day;
+    unsigned int generation;    // 发起时的 Stats 版本
+    long buckets[12];
+};
+
+static bool s_day_load_running = false;
+
+static gboolean day_load_done_idle(gpointer data) {
+    DayLoadJob *job = (DayLoadJob *)data;
+    s_day_load_running = false;
+
+    // 期间翻到了别的日期或重读了日志时结果作废，下面按当前日期重新发起
+    if (g_view_data.view_daily_pending && job->day == g_view_daily_ts
+        && job->generation == stats_current()->generation) {
+        set_daily_view_data(g_view_data, job->buckets);
+        if (g_daily_widgets) {
+            update_daily_view_ui(g_daily_widgets);
+            gtk_widget_queue_draw(g_daily_widgets->drawing_area);
+        }
+    }
+    delete job;
+
+    daily_view_load_pending();
+    return FALSE;
+}
+
+static void* day_load_thread(void *data) {
+    DayLoadJob *job = (DayLoadJob *)data;
+    detail_cache_get(job->day, job->buckets);
+    g_idle_add(day_load_done_idle, job);
+    return NULL;
+}
+
+void daily_view_load_pending() {
+    if (!g_view_data.view_daily_pending || s_day_load_running) return;
+
+    DayLoadJob *job = new DayLoadJob();
+    job->day = g_view_daily_ts;
+    job->generation = stats_current()->generation;
+    std::fill(job->buckets, job->buckets + 12, 0);
+
+    pthread_t tid;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&tid, &attr, day_load_thread, job) == 0) {
+        s_day_load_running = true;
+    } else {
+        // 起不了线程时按无记录显示，不在 UI 线程解析日志
+        set_daily_view_data(g_view_data, job->buckets);
+        delete job;
+    }
+    pthread_attr_destroy(&attr);
+}
+
+// 切换到 g_view_daily_ts：有可用的预取结果时直接换入数据和图表
+static void apply_view_day(DailyViewWidgets *dv) {
+    auto it = s_day_prefetch.find(g_view_daily_ts);
+    if (it != s_day_prefetch.end() && it->second.generation == stats_current()->generation) {
+        set_daily_view_data(g_view_data, it->second.buckets);
+        chart_cache_adopt(s_today_cache, it->second.image, dv->drawing_area, g_view_data.daily_version);
+        s_day_prefetch.erase(it);
+    } else {
+        refresh_daily_view_data(g_view_data, g_view_daily_ts);
+        daily_view_load_pending();
+    }
+}
+
+static NavScheduler s_daily_nav;
+
+static void commit_daily_change(gpointer data) {
+    DailyViewWidgets *dv = (DailyViewWidgets*)data;
+
+    // 只更新日视图数据，优先使用预取结果
+    apply_view_day(dv);
+    
+    // 更新UI和重绘
+    update_daily_view_ui(dv);
+    gtk_widget_queue_draw(dv->drawing_area);
+    schedule_day_prefetch();
+}
+
 // 前一天/后一天 按钮回调
 void on_daily_change(GtkButton *btn, gpointer data) {
     DailyViewWidgets *dv = (DailyViewWidgets*)data;
     int offset = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(btn), "offset"));
     
-    // 调整日期
-    g_view_daily_ts += (offset * 24 * 3600);
-    
-    // 重新计算数据
-    // 注意：force_reload=true 会重读文件，虽然略慢但最准确
-    read_logs_and_compute_stats(g_stats, g_view_year, g_view_month, false);
+    // 调整日期 (按日历天数，跨夏令时也落在当天 0 点)
+    g_view_daily_ts = add_days(g_view_daily_ts, offset);
     
-    // 更新UI和重绘
-    update_daily_view_ui(dv);
-    gtk_widget_queue_draw(dv->drawing_area);
+    // 日期立即更新，数据和重绘等点击停下后只做一次
+    update_daily_date_labels(dv);
+    prefetch_cancel(PREFETCH_DAY);
+    nav_request(s_daily_nav, commit_daily_change, dv);
 }
 
-GtkWidget* create_today_page() {
-    // 初始化查看日期为今天
-    time_t now = time(NULL);
-    g_view_daily_ts = get_day_start(now);
+// 跳转到指定日期的日视图 (供日历、年度热力图点击使用)
+void show_daily_view(time_t day_ts) {
+    // 1. 更新全局日期并刷新数据
+    g_view_daily_ts = day_ts;
+
+    // 2. 更新日视图 UI (直接跳到目标日期，尚未提交的翻页请求作废)
+    if (g_daily_widgets) {
+        nav_cancel(s_daily_nav);
+        commit_daily_change(g_daily_widgets);
+    } else {
+        refresh_daily_view_data(g_view_data, g_view_daily_ts);
+        daily_view_load_pending();
+    }
 
+    // 3. 切换到 "时段详情" Tab (索引 1)
+    if (g_notebook) {
+        gtk_notebook_set_current_page(GTK_NOTEBOOK(g_notebook), 1);
+    }
+}
+
+GtkWidget* create_today_page() {
     DailyViewWidgets *dv = (DailyViewWidgets*)g_malloc0(sizeof(DailyViewWidgets));
     g_daily_widgets = dv;
     GtkWidget *vbox = gtk_vbox_new(FALSE, 0);
@@ -178,8 +360,7 @@ GtkWidget* create_today_page() {
     gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(vbox), dv->drawing_area, TRUE, TRUE, 0);
 
-    // 初始显示更新
-    read_logs_and_compute_stats(g_stats, g_view_year, g_view_month, true);
+    // 初始显示更新 (视图数据已在 main 中按当前 Stats 版本生成)
     update_daily_view_ui(dv);
 
     pango_font_description_free(font_big);
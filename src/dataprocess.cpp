@@ -1,17 +1,23 @@
 #include <cstring>
 #include <string>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
 #include <dirent.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include "types.hpp"
 #include "utils.hpp"
 #include "dataprocess.hpp"
+#include "snapshot.hpp"
+#include "detailcache.hpp"
+#include "trace.hpp"
 
-// 解析单行并更新 Stats
-void parse_line_and_update(char *line, Stats &s, 
-                                  time_t today_start, time_t tomorrow_start,
-                                  time_t week_start, time_t week_end,
-                                  time_t cur_month_start, time_t cur_month_end) 
+// 解析单行，得到一次阅读的起止时间；不是阅读时长记录时返回 false
+static bool parse_reading_line(char *line, time_t &start_time, time_t &end_time)
 {
     char *saveptr = NULL;
     char *token = strtok_r(line, ",", &saveptr);
@@ -29,36 +35,19 @@ void parse_line_and_update(char *line, Stats &s,
     }
 
     if (strncmp(type_field, "com.lab126.booklet.reader.activeDuration", 40) != 0)
-        return;
+        return false;
 
     long dur = dur_ms / 1000;
-    if (dur <= 0) return;
+    if (dur <= 0) return false;
 
-    time_t end_time = (time_t)endt;
-    time_t start_time = end_time - dur;
-
-    s.total_seconds += dur;
-
-    // 1. 更新今日/本周/本月 总数 (保持原有逻辑，用于概览页快速显示)
-    if (end_time > today_start && start_time < tomorrow_start) {
-        time_t sclip = std::max(start_time, today_start);
-        time_t eclip = std::min(end_time, tomorrow_start);
-        if (eclip > sclip) s.today_seconds += (eclip - sclip);
-    }
-
-    if (end_time > week_start && start_time < week_end) {
-        time_t sclip = std::max(start_time, week_start);
-        time_t eclip = std::min(end_time, week_end);
-        if (eclip > sclip) s.week_seconds += (eclip - sclip);
-    }
-
-    if (end_time > cur_month_start && start_time < cur_month_end) {
-        time_t sclip = std::max(start_time, cur_month_start);
-        time_t eclip = std::min(end_time, cur_month_end);
-        if (eclip > sclip) s.month_seconds += (eclip - sclip);
-    }
+    end_time = (time_t)endt;
+    start_time = end_time - dur;
+    return true;
+}
 
-    // 2. 通用分桶逻辑：将这段阅读时间分配到对应的日期Map中
+// 通用分桶逻辑：将一段阅读时间分配到对应的日期 Map 中
+static void accumulate_reading(Stats &s, DetailMap &details, time_t start_time, time_t end_time)
+{
     time_t t_cursor = start_time;
     while (t_cursor < end_time) {
         // 获取当前游标所在的自然日 0点
@@ -68,13 +57,14 @@ void parse_line_and_update(char *line, Stats &s,
         // 当前处理片段在这一天内的结束时间
         time_t seg_end = std::min(end_time, day_end);
         
-        // 如果跨天，确保 Map 中该天的 vector 已初始化
-        if (s.daily_detail_map[day_start].empty()) {
-            s.daily_detail_map[day_start].resize(12, 0);
-        }
+        // 如果跨天，取出 (或新建) 该天的分桶记录
+        DayBuckets &buckets = details[day_start];
         
-        // 每日总数 Map 更新
+        // 每日总数 / 每月总数 Map 更新
         s.history_map[day_start] += (seg_end - t_cursor);
+        struct tm day_tm;
+        localtime_r(&day_start, &day_tm);
+        s.month_map[(day_tm.tm_year + 1900) * 100 + day_tm.tm_mon + 1] += (seg_end - t_cursor);
 
         // 处理当天的分桶 (2小时一桶)
         time_t bucket_cursor = t_cursor;
@@ -89,7 +79,7 @@ void parse_line_and_update(char *line, Stats &s,
             
             long step_sec = bucket_end_time - bucket_cursor;
             if (step_sec > 0) {
-                s.daily_detail_map[day_start][bi] += step_sec;
+                add_bucket_seconds(buckets, bi, step_sec);
             }
             
             bucket_cursor = bucket_end_time;
@@ -97,191 +87,214 @@ void parse_line_and_update(char *line, Stats &s,
 
         t_cursor = seg_end; // 继续处理下一天（如果跨天阅读）
     }
+}
 
-    // 3. 本周分天 (保持不变)
-    if (end_time > week_start && start_time < week_end) {
-        time_t sclip = std::max(start_time, week_start);
-        time_t eclip = std::min(end_time, week_end);
-        time_t tcur = sclip;
-        while (tcur < eclip) {
-            int di = (tcur - week_start) / (24 * 3600);
-            if (di < 0) di = 0; 
-            if (di > 6) di = 6;
-            time_t dend = week_start + (di + 1) * 24 * 3600;
-            if (dend > eclip) dend = eclip;
-            s.week_days[di] += (dend - tcur);
-            tcur = dend;
-        }
-    }
+// 解析单行并更新 Stats 与分桶详情
+// 只累加到每日/每月 Map 中，今日/本周/本月总数由 finalize_period_totals 统一计算
+void parse_line_and_update(char *line, Stats &s, DetailMap &details)
+{
+    time_t start_time, end_time;
+    if (!parse_reading_line(line, start_time, end_time)) return;
 
+    s.total_seconds += end_time - start_time;
+    accumulate_reading(s, details, start_time, end_time);
 }
 
-// —— 数据预处理 ——
-void preprocess_data() {
-    // 1. 确定当月文件名后缀 (YYMM)
+// 当月日志文件名，例如 metrics_reader_2610
+static void get_current_log_name(char *buf, size_t sz) {
     time_t now = time(NULL);
     struct tm tmv;
     localtime_r(&now, &tmv);
-    char current_month_suffix[16];
     // tm_year 是从1900起算的年数，% 100 得到 YY
-    snprintf(current_month_suffix, sizeof(current_month_suffix), "%02d%02d", 
-             (tmv.tm_year + 1900) % 100, tmv.tm_mon + 1);
+    snprintf(buf, sz, "%s%02d%02d", LOG_PREFIX, (tmv.tm_year + 1900) % 100, tmv.tm_mon + 1);
+}
 
-    char current_log_filename[128];
-    snprintf(current_log_filename, sizeof(current_log_filename), "%s%s", LOG_PREFIX, current_month_suffix);
+// TEMP_LOG_FILE 当前内容对应的归档状态 (-2 表示尚未解压过)
+static long long s_extracted_archive_size = -2;
+static long long s_extracted_archive_mtime = 0;
 
-    // 2. 准备临时文件
-    // 如果存在 history.gz，解压覆盖到 TEMP；否则创建空文件
-    char cmd[512];
+static void stat_archive(long long &size, long long &mtime) {
     struct stat st;
     if (stat(ARCHIVE_FILE.c_str(), &st) == 0) {
+        size = st.st_size;
+        mtime = st.st_mtime;
+    } else {
+        size = -1;
+        mtime = 0;
+    }
+}
+
+// 确保 TEMP_LOG_FILE 与 history.gz 一致
+// 只有需要全量解析或合并旧日志时才调用，快照有效时可以完全跳过解压
+// TEMP_LOG_FILE 可能被后台加载线程和日视图的读取线程 (分桶缓存未命中时) 同时使用，由 s_history_mutex 保护
+static std::mutex s_history_mutex;
+
+// 调用方需持有 s_history_mutex
+static void ensure_history_log_locked() {
+    long long size, mtime;
+    stat_archive(size, mtime);
+    if (size == s_extracted_archive_size && mtime == s_extracted_archive_mtime) return;
+
+    // 如果存在 history.gz，解压覆盖到 TEMP；否则创建空文件
+    if (size >= 0) {
+        TRACE_SCOPE("gunzip");
+        char cmd[512];
         snprintf(cmd, sizeof(cmd), "gunzip -c %s > %s", ARCHIVE_FILE.c_str(), TEMP_LOG_FILE);
         system(cmd);
     } else {
-        // 创建空文件
         FILE *fp = fopen(TEMP_LOG_FILE, "w");
         if (fp) fclose(fp);
     }
+    s_extracted_archive_size = size;
+    s_extracted_archive_mtime = mtime;
+}
 
-    // 3. 扫描目录，追加旧日志
-    DIR *dir = opendir(LOG_DIR.c_str());
-    if (!dir) return;
+static void ensure_history_log() {
+    std::lock_guard<std::mutex> lock(s_history_mutex);
+    ensure_history_log_locked();
+}
 
-    FILE *fp_temp = fopen(TEMP_LOG_FILE, "a"); // 追加模式
-    if (!fp_temp) {
+// —— 数据预处理 ——
+// 将非当月的旧日志合并进 history.gz
+void preprocess_data() {
+    TRACE_SCOPE("preprocess");
+
+    // 1. 确定当月文件名
+    char current_log_filename[128];
+    get_current_log_name(current_log_filename, sizeof(current_log_filename));
+
+    // 2. 扫描目录，收集旧日志；没有旧日志时不需要动归档
+    std::vector<std::string> old_logs;
+    {
+        TRACE_SCOPE("scan_log_dir");
+        DIR *dir = opendir(LOG_DIR.c_str());
+        if (!dir) return;
+
+        struct dirent *ent;
+        while ((ent = readdir(dir)) != NULL) {
+            // 筛选 metrics_reader_ 开头
+            if (strncmp(ent->d_name, LOG_PREFIX, strlen(LOG_PREFIX)) != 0) continue;
+
+            // 跳过当月日志
+            if (strcmp(ent->d_name, current_log_filename) == 0) continue;
+
+            old_logs.push_back(LOG_DIR + ent->d_name);
+        }
         closedir(dir);
-        return;
     }
 
-    struct dirent *ent;
-    bool has_updates = false;
-    char filepath[512];
+    if (old_logs.empty()) return;
 
-    while ((ent = readdir(dir)) != NULL) {
-        // 筛选 metrics_reader_ 开头
-        if (strncmp(ent->d_name, LOG_PREFIX, strlen(LOG_PREFIX)) != 0) continue;
-        
-        // 跳过当月日志
-        if (strcmp(ent->d_name, current_log_filename) == 0) continue;
+    // 3. 准备临时文件，追加旧日志
+    std::lock_guard<std::mutex> lock(s_history_mutex);
+    ensure_history_log_locked();
 
-        // 处理旧日志
-        snprintf(filepath, sizeof(filepath), "%s%s", LOG_DIR.c_str(), ent->d_name);
-        
-        FILE *fp_old = fopen(filepath, "r");
+    FILE *fp_temp = fopen(TEMP_LOG_FILE, "a"); // 追加模式
+    if (!fp_temp) return;
+
+    bool has_updates = false;
+    for (const std::string &filepath : old_logs) {
+        FILE *fp_old = fopen(filepath.c_str(), "r");
         if (fp_old) {
             char buffer[1024];
             while (fgets(buffer, sizeof(buffer), fp_old)) {
                 fputs(buffer, fp_temp);
             }
             fclose(fp_old);
-            unlink(filepath); // 删除旧文件
+            unlink(filepath.c_str()); // 删除旧文件
             has_updates = true;
         }
     }
     fclose(fp_temp);
-    closedir(dir);
 
     // 4. 如果有追加操作，重新压缩归档 (保存到 LOG_DIR)
     if (has_updates) {
+        TRACE_SCOPE("gzip");
+        char cmd[512];
         snprintf(cmd, sizeof(cmd), "gzip -c %s > %s", TEMP_LOG_FILE, ARCHIVE_FILE.c_str());
         system(cmd);
+        // TEMP 已经是新归档的内容，记录下来避免重复解压
+        stat_archive(s_extracted_archive_size, s_extracted_archive_mtime);
     }
 }
 
-// 从内存 Map 中提取指定日期的数据到 view_daily_buckets
-void refresh_daily_view_data(Stats &s, time_t target_day_ts) {
-    // 1. 重置当前视图数据
-    std::fill(std::begin(s.view_daily_buckets), std::end(s.view_daily_buckets), 0);
-    s.view_daily_seconds = 0;
-
-    // 2. 查找 Map
-    if (s.daily_detail_map.count(target_day_ts)) {
-        const std::vector<long> &vec = s.daily_detail_map[target_day_ts];
-        if (vec.size() >= 12) {
-            for (int i = 0; i < 12; i++) {
-                s.view_daily_buckets[i] = vec[i];
-                s.view_daily_seconds += vec[i];
-            }
-        }
+// —— Stats 版本发布 ——
+// 当前版本只通过 atomic_load/atomic_store 访问 shared_ptr：读者拿到引用后
+// 即持有一份完整、不会再变化的快照，发布新版本不会影响正在读旧版本的线程
+static StatsRef g_current_stats = std::make_shared<const Stats>();
+static std::atomic<unsigned int> g_stats_generation(0);
+
+StatsRef stats_current() {
+    return std::atomic_load(&g_current_stats);
+}
+
+void stats_publish(StatsRef s) {
+    std::atomic_store(&g_current_stats, s);
+}
+
+// 从分桶详情缓存中提取指定日期的数据到 view_daily_buckets
+void refresh_daily_view_data(ViewData &v, time_t target_day_ts) {
+    // 只查缓存和快照，没有记录时全为 0。
+    // 已被淘汰、只能重新解析日志的日期不在这里读 (UI 线程也会调用)，
+    // 先标记为读取中，由日视图放到后台线程 (见 daily_view_load_pending)
+    long buckets[12] = {0};
+    bool ready = detail_cache_peek(target_day_ts, buckets);
+    set_daily_view_data(v, buckets, !ready);
+}
+
+// 写入某一天的分桶，内容或读取状态有变化时递增 daily_version
+void set_daily_view_data(ViewData &v, const long buckets[12], bool pending) {
+    if (pending != v.view_daily_pending || !std::equal(buckets, buckets + 12, v.view_daily_buckets))
+        v.daily_version++;
+
+    v.view_daily_pending = pending;
+    v.view_daily_seconds = 0;
+    for (int i = 0; i < 12; i++) {
+        v.view_daily_buckets[i] = buckets[i];
+        v.view_daily_seconds += buckets[i];
     }
 }
 
-// —— 读取日志与计算 ——
-// 参数说明：
-// force_reload: true=重新读取磁盘文件; false=仅重新生成视图数据(用于翻页)
-void read_logs_and_compute_stats(Stats &s, int view_year, int view_month, bool force_reload) {
-    
-    // 1. 初始化/清理
-    // 只有在强制重载时，才清空所有核心数据
-    if (force_reload || !s.loaded) {
-        s.total_seconds = 0;
-        s.today_seconds = 0;
-        s.week_seconds = 0;
-        s.month_seconds = 0;
-        s.view_daily_seconds = 0;
-        
-        // 使用 std::fill 初始化数组，安全且标准
-        std::fill(std::begin(s.view_daily_buckets), std::end(s.view_daily_buckets), 0);
-        std::fill(std::begin(s.week_days), std::end(s.week_days), 0);
-        
-        // 清空 Map
-        s.history_map.clear();
-        s.daily_detail_map.clear();
-        s.loaded = true;
-
-        // --- 准备时间边界 (用于 parse_line 里的判断) ---
-        time_t today_start, tomorrow_start;
-        get_today_bounds(today_start, tomorrow_start);
-
-        time_t week_start;
-        get_week_start(week_start);
-        time_t week_end = week_start + 7 * 24 * 3600;
-
-        time_t cur_month_start;
-        int cur_year, cur_month;
-        get_month_start(cur_month_start, cur_year, cur_month);
-        time_t cur_month_end = cur_month_start + days_in_month(cur_year, cur_month) * 24 * 3600;
-
-        // --- 读取文件 Lambda ---
-        auto process_file = [&](const char* fpath) {
-            FILE *fp = fopen(fpath, "r");
-            if (!fp) return;
-            char line[512];
-            while (fgets(line, sizeof(line), fp)) {
-                // 调用简化后的解析函数
-                parse_line_and_update(line, s, 
-                    today_start, tomorrow_start,
-                    week_start, week_end,
-                    cur_month_start, cur_month_end
-                );
-            }
-            fclose(fp);
-        };
-
-        // 读取历史汇总
-        process_file(TEMP_LOG_FILE);
-
-        // 读取当月实时日志
-        time_t now = time(NULL);
-        struct tm now_tm;
-        localtime_r(&now, &now_tm);
-        char current_path[256];
-        snprintf(current_path, sizeof(current_path), "%s%s%02d%02d", 
-                 LOG_DIR.c_str(), LOG_PREFIX, (now_tm.tm_year + 1900) % 100, now_tm.tm_mon + 1);
-        process_file(current_path);
+// 从每日总数 Map 中提取某一周 (周一起) 的 7 天数据，无需重读日志
+void compute_week_days(const Stats &s, time_t week_start, long out[7]) {
+    time_t day = week_start;
+    for (int i = 0; i < 7; i++) {
+        auto it = s.history_map.find(day);
+        out[i] = (it != s.history_map.end()) ? it->second : 0;
+        day = add_days(day, 1);
     }
+}
 
-    // 2. 生成视图数据
+// 刷新当前查看周的视图数据
+void refresh_week_view_data(ViewData &v, const Stats &s, time_t week_start) {
+    long days[7];
+    compute_week_days(s, week_start, days);
+    set_week_view_data(v, week_start, days);
+}
 
-    // 无论是否重读了文件，都根据全局的查看日期刷新一下分桶数据
-    refresh_daily_view_data(s, g_view_daily_ts);
+// 写入某一周的数据，内容或 "是否本周" 有变化时递增 week_version
+void set_week_view_data(ViewData &v, time_t week_start, const long days[7]) {
+    time_t cur_week_start;
+    get_week_start(cur_week_start);
+    bool is_current = (week_start == cur_week_start);
 
-    // 无论是否重读文件，都根据 view_year/view_month 从 map 中提取数据
-    s.month_year = view_year;
-    s.month_month = view_month;
+    if (v.view_week_start != week_start || !std::equal(days, days + 7, v.view_week_days)
+        || v.view_week_is_current != is_current) {
+        v.week_version++;
+    }
+    v.view_week_start = week_start;
+    v.view_week_is_current = is_current;
+    v.view_week_seconds = 0;
+    for (int i = 0; i < 7; i++) {
+        v.view_week_days[i] = days[i];
+        v.view_week_seconds += days[i];
+    }
+}
 
+// 从每日总数 Map 中提取指定月份每天的数据
+void compute_month_days(const Stats &s, int view_year, int view_month, std::vector<long> &out) {
     int vdays = days_in_month(view_year, view_month);
-    s.month_day_seconds.assign(vdays, 0);
+    out.assign(vdays, 0);
 
     // 构造该月每一天的时间戳，去 Map 里查
     struct tm tmv;
@@ -292,11 +305,265 @@ void read_logs_and_compute_stats(Stats &s, int view_year, int view_month, bool f
 
     for (int d = 1; d <= vdays; d++) {
         tmv.tm_mday = d;
+        tmv.tm_isdst = -1;
         time_t day_ts = mktime(&tmv); // 获取该日0点时间戳
-        
+
         // 如果 Map 里有记录，就填入 vector
-        if (s.history_map.count(day_ts)) {
-            s.month_day_seconds[d - 1] = s.history_map[day_ts];
+        auto it = s.history_map.find(day_ts);
+        if (it != s.history_map.end()) {
+            out[d - 1] = it->second;
+        }
+    }
+}
+
+// 刷新当前查看月的视图数据
+void refresh_month_view_data(ViewData &v, const Stats &s, int view_year, int view_month) {
+    std::vector<long> days;
+    compute_month_days(s, view_year, view_month, days);
+    set_month_view_data(v, view_year, view_month, days, g_daily_target_minutes);
+}
+
+// 写入某个月每天的数据与灰度基准，内容有变化时递增 month_version
+void set_month_view_data(ViewData &v, int view_year, int view_month, const std::vector<long> &days,
+                         int target_minutes) {
+    bool same_month = (v.month_year == view_year && v.month_month == view_month);
+    if (!same_month || v.month_day_seconds != days || v.month_target_minutes != target_minutes) {
+        v.month_version++;
+    }
+
+    v.month_year = view_year;
+    v.month_month = view_month;
+    v.month_target_minutes = target_minutes;
+    v.month_day_seconds = days;
+}
+
+// 从 offset 处开始解析日志文件，返回已解析部分之后的偏移量
+// live 为真时 (当月实时日志，偏移量会写进快照) 文件末尾未写完的半行不解析，
+// 留到下次从该处继续；归档等不再追加的文件一直解析到末尾，最后一行没有换行也算数
+// progress 非空时定期更新已处理字节数/记录数，发现取消标志后立即返回
+static long long ingest_file(const char *fpath, Stats &s, DetailMap &details, long long offset,
+                             bool live, LoadProgress *progress) {
+    FILE *fp = fopen(fpath, "r");
+    if (!fp) return offset;
+    if (offset > 0 && fseeko(fp, offset, SEEK_SET) != 0) {
+        fclose(fp);
+        return offset;
+    }
+
+    char line[512];
+    long long pos = offset;
+    long long reported = offset;
+    long lines = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        size_t len = strlen(line);
+        bool complete = (len > 0 && line[len - 1] == '\n');
+        if (live && !complete && feof(fp)) break;
+
+        // 调用简化后的解析函数
+        parse_line_and_update(line, s, details);
+        pos += len;
+
+        if (progress && (++lines & 1023) == 0) {
+            progress->bytes_done += (pos - reported);
+            progress->records += 1024;
+            reported = pos;
+            if (progress->cancel) break;
+        }
+    }
+    fclose(fp);
+    if (progress) {
+        progress->bytes_done += (pos - reported);
+        progress->records += (lines & 1023);
+    }
+    return pos;
+}
+
+// 根据每日 Map 计算今日/本周/本月总数 (与当前时间有关，不持久化)
+static void finalize_period_totals(Stats &s) {
+    auto day_seconds = [&](time_t day) -> long {
+        auto it = s.history_map.find(day);
+        return (it != s.history_map.end()) ? it->second : 0;
+    };
+
+    time_t today_start, tomorrow_start;
+    get_today_bounds(today_start, tomorrow_start);
+    s.today_seconds = day_seconds(today_start);
+
+    time_t week_start;
+    get_week_start(week_start);
+    s.week_seconds = 0;
+    for (int i = 0; i < 7; i++) s.week_seconds += day_seconds(add_days(week_start, i));
+
+    time_t cur_month_start;
+    int cur_year, cur_month;
+    get_month_start(cur_month_start, cur_year, cur_month);
+    auto it = s.month_map.find(cur_year * 100 + cur_month);
+    s.month_seconds = (it != s.month_map.end()) ? it->second : 0;
+}
+
+// —— 读取日志，构造新的 Stats 版本 ——
+// 不访问任何全局视图状态，可在任意线程调用
+// 快照有效时只解析当月日志中快照之后新增的部分，否则全量重建
+// progress 非空时报告进度；途中被取消则返回空指针，不写快照也不改动缓存
+StatsRef build_stats(LoadProgress *progress) {
+    TRACE_SCOPE("build_stats");
+    std::shared_ptr<Stats> s = std::make_shared<Stats>();
+    DetailMap details;
+
+    // 1. 当前源文件状态
+    StatsSource cur;
+    memset(&cur, 0, sizeof(cur));
+    stat_archive(cur.archive_size, cur.archive_mtime);
+    get_current_log_name(cur.log_name, sizeof(cur.log_name));
+    std::string current_path = LOG_DIR + cur.log_name;
+
+    struct stat log_st;
+    long long log_size = -1;
+    if (stat(current_path.c_str(), &log_st) == 0) {
+        log_size = log_st.st_size;
+    }
+
+    // 2. 尝试加载快照并校验：归档未变，当月日志同名、没有变短、检查点之前的内容没变 (只追加过)。
+    // 快照只读入每日/每月总数，旧的分桶留在映射里，保存新快照时再与新解析的部分合并
+    SnapshotFile base;
+    bool snapshot_valid = load_stats_snapshot(*s, &base)
+        && s->source.archive_size == cur.archive_size
+        && s->source.archive_mtime == cur.archive_mtime
+        && strcmp(s->source.log_name, cur.log_name) == 0
+        && (s->source.log_offset == 0
+            || (log_size >= s->source.log_offset
+                && log_checkpoint_sum(current_path, s->source.log_offset) == s->source.log_check));
+
+    // 解析期间只常驻预算内的天数，更早的分桶写到快照旁的临时文件，全量重建十年日志也不会撑大内存
+    size_t window = detail_cache_day_capacity();
+    if (window) details.set_window(window, SNAPSHOT_FILE + ".spill.XXXXXX");
+
+    long long offset = 0;
+    if (snapshot_valid) {
+        offset = s->source.log_offset;
+        if (progress) progress->bytes_total = std::max(0LL, log_size - offset);
+    } else {
+        // 快照缺失、过期或损坏：全量重建
+        *s = Stats();
+        details.clear();
+        base.close();
+
+        std::lock_guard<std::mutex> lock(s_history_mutex);
+        ensure_history_log_locked();
+        if (progress) {
+            struct stat temp_st;
+            long long temp_size = (stat(TEMP_LOG_FILE, &temp_st) == 0) ? temp_st.st_size : 0;
+            progress->bytes_total = temp_size + std::max(0LL, log_size);
         }
+        TRACE_SCOPE("parse_history");
+        ingest_file(TEMP_LOG_FILE, *s, details, 0, false, progress);
+    }
+    if (progress && progress->cancel) return StatsRef();
+
+    // 3. 解析当月实时日志 (快照有效时只读增量)
+    {
+        TRACE_SCOPE("parse_current_log");
+        cur.log_offset = ingest_file(current_path.c_str(), *s, details, offset, true, progress);
+    }
+    if (progress && progress->cancel) return StatsRef();
+    // 检查点之前的内容只会追加不会再变，之后补算校验和即可
+    cur.log_check = log_checkpoint_sum(current_path, cur.log_offset);
+    bool changed = !snapshot_valid || cur.log_offset != offset;
+    s->source = cur;
+
+    s->generation = ++g_stats_generation;
+    finalize_period_totals(*s);
+
+    // 4. 有新数据时更新快照
+    if (changed) save_stats_snapshot(*s, details, snapshot_valid ? &base : NULL);
+    base.close();
+
+    // 5. 缓存从快照读入预算内最近的分桶，其余按需读取。
+    // 快照没能写入时，全量重建的常驻窗口就是最近几天的完整分桶；增量时窗口里只有新增部分，不能用
+    SnapshotFile latest;
+    if (latest.open(false) && latest.same_source(s->source)) {
+        detail_cache_reset(latest);
+    } else {
+        if (snapshot_valid) details.clear();
+        detail_cache_reset(std::move(details));
+    }
+
+    return s;
+}
+
+// —— 启动时先发布上次保存的快照 ——
+// 不校验源文件、不解压归档，只 mmap 一次快照文件，界面可以立即绘制；
+// 快照不存在时发布一个空版本。两种情况都标记为 provisional，等待 build_stats 替换
+void publish_cached_stats() {
+    TRACE_SCOPE("cached_stats");
+    std::shared_ptr<Stats> s = std::make_shared<Stats>();
+    SnapshotFile snap;
+
+    if (!load_stats_snapshot(*s, &snap)) {
+        *s = Stats();
     }
+    s->provisional = true;
+    s->generation = ++g_stats_generation;
+    finalize_period_totals(*s);
+
+    detail_cache_reset(snap);
+    stats_publish(s);
+}
+
+// 从源日志中重新计算某一天的分桶 (分桶详情缓存未命中且快照不可用时使用)
+bool reparse_day_detail(time_t day_start, DayBuckets &out) {
+    ensure_history_log();
+
+    Stats scratch = Stats();
+    DetailMap details;
+    time_t day_end = add_days(day_start, 1);
+
+    auto scan = [&](const char *fpath) {
+        FILE *fp = fopen(fpath, "r");
+        if (!fp) return;
+        char line[512];
+        while (fgets(line, sizeof(line), fp)) {
+            time_t start_time, end_time;
+            if (!parse_reading_line(line, start_time, end_time)) continue;
+            // 只累加落在目标日期内的部分
+            start_time = std::max(start_time, day_start);
+            end_time = std::min(end_time, day_end);
+            if (end_time > start_time) {
+                accumulate_reading(scratch, details, start_time, end_time);
+            }
+        }
+        fclose(fp);
+    };
+
+    char log_name[32];
+    get_current_log_name(log_name, sizeof(log_name));
+    scan(TEMP_LOG_FILE);
+    scan((LOG_DIR + log_name).c_str());
+
+    const DayBuckets *b = details.find(day_start);
+    if (!b) return false;
+    out = *b;
+    return true;
+}
+
+// —— 视图数据 ——
+// 只根据当前 Stats 版本刷新各视图数据，不读日志
+void refresh_view_data(ViewData &v, int view_year, int view_month) {
+    StatsRef s = stats_current();
+    refresh_daily_view_data(v, g_view_daily_ts);
+    refresh_week_view_data(v, *s, g_view_week_start);
+    refresh_month_view_data(v, *s, view_year, view_month);
+}
+
+// —— 内存占用报告 (调试版本退出时打印) ——
+void print_memory_report() {
+    StatsRef s = stats_current();
+    size_t day_bytes = s->history_map.size() * map_node_bytes<decltype(s->history_map)>();
+    size_t month_bytes = s->month_map.size() * map_node_bytes<decltype(s->month_map)>();
+
+    fprintf(stderr, "[kykky] memory report (generation %u)\n", s->generation);
+    fprintf(stderr, "  Stats        : %zu B (struct %zu B, history_map %zu days %zu B, month_map %zu months %zu B)\n",
+            sizeof(Stats) + day_bytes + month_bytes, sizeof(Stats),
+            s->history_map.size(), day_bytes, s->month_map.size(), month_bytes);
+    detail_cache_report(stderr);
 }
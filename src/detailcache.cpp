@@ -0,0 +1,194 @@
+#include <cstdio>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
+
+#include "types.hpp"
+#include "dataprocess.hpp"
+#include "snapshot.hpp"
+#include "detailcache.hpp"
+
+struct DetailEntry {
+    time_t day_start;
+    DayBuckets *buckets;    // 指向 s_arena 中的记录
+};
+
+typedef std::list<DetailEntry> DetailList;
+typedef std::unordered_map<time_t, DetailList::iterator> DetailIndex;
+
+// 单条记录的索引开销估算：链表节点 (前后指针) + 哈希节点 (next 指针) + 桶数组槽位
+// 分桶数据本身按记录池实际占用的块计算
+static const size_t DETAIL_INDEX_COST =
+    sizeof(DetailEntry) + 2 * sizeof(void *)
+    + sizeof(DetailIndex::value_type) + 2 * sizeof(void *);
+
+static std::mutex s_cache_mutex;
+static BucketArena s_arena(32);
+static DetailList s_lru;            // 头部为最近访问
+static DetailIndex s_index;
+static unsigned int s_cache_epoch = 0;
+static size_t s_cache_hits = 0;
+static size_t s_cache_misses = 0;
+
+size_t detail_cache_budget() {
+    return g_detail_cache_kib > 0 ? (size_t)g_detail_cache_kib * 1024 : 0;
+}
+
+// 调用方需持有 s_cache_mutex
+static size_t cache_bytes_locked() {
+    return s_lru.size() * DETAIL_INDEX_COST + s_arena.reserved_bytes();
+}
+
+size_t detail_cache_bytes() {
+    std::lock_guard<std::mutex> lock(s_cache_mutex);
+    return cache_bytes_locked();
+}
+
+// 再放一条记录后是否仍在预算内 (调用方需持有 s_cache_mutex)
+static bool has_room() {
+    size_t budget = detail_cache_budget();
+    if (budget == 0) return true;
+    size_t extra = DETAIL_INDEX_COST + (s_arena.has_free() ? 0 : s_arena.block_bytes());
+    return cache_bytes_locked() + extra <= budget;
+}
+
+static void evict_oldest() {
+    s_arena.release(s_lru.back().buckets);
+    s_index.erase(s_lru.back().day_start);
+    s_lru.pop_back();
+}
+
+static void insert_front(time_t day_start, const DayBuckets &b) {
+    while (!has_room() && !s_lru.empty()) {
+        evict_oldest();
+    }
+    if (!has_room()) return;
+
+    DetailEntry e;
+    e.day_start = day_start;
+    e.buckets = s_arena.alloc();
+    *e.buckets = b;
+    s_lru.push_front(e);
+    s_index[day_start] = s_lru.begin();
+}
+
+size_t detail_cache_day_capacity() {
+    size_t budget = detail_cache_budget();
+    if (budget == 0) return 0;
+    // 至少容纳一个月，日视图翻页和当月统计不至于反复读盘
+    return std::max<size_t>(31, budget / (DETAIL_INDEX_COST + sizeof(DayBuckets)));
+}
+
+// 调用方需持有 s_cache_mutex
+static void clear_locked() {
+    s_lru.clear();
+    s_index.clear();
+    s_arena.clear();
+    s_cache_epoch++;
+}
+
+// 按从新到旧的顺序追加到链表尾部 (调用方需持有 s_cache_mutex)
+static void append_back(time_t day_start, const DayBuckets &b) {
+    DetailEntry e;
+    e.day_start = day_start;
+    e.buckets = s_arena.alloc();
+    *e.buckets = b;
+    s_lru.push_back(e);
+    s_index[day_start] = std::prev(s_lru.end());
+}
+
+void detail_cache_reset(const SnapshotFile &snap) {
+    std::lock_guard<std::mutex> lock(s_cache_mutex);
+    clear_locked();
+
+    size_t n = snap.valid() ? snap.day_count() : 0;
+    for (size_t i = n; i > 0 && has_room(); i--) {
+        DayBuckets b;
+        snap.buckets_at(i - 1, b);
+        append_back(snap.day_at(i - 1), b);
+    }
+}
+
+void detail_cache_reset(DetailMap &&details) {
+    std::lock_guard<std::mutex> lock(s_cache_mutex);
+    clear_locked();
+
+    // 从最新的日期开始装入，放不下时停止，更早的日期留在快照里
+    for (auto it = details.rbegin(); it != details.rend() && has_room(); ++it) {
+        append_back(it->first, *it->second);
+    }
+
+    details.clear();
+}
+
+// found: 当天是否有分桶；返回 false 表示只有重新解析日志才能得到结果而 allow_reparse 为假
+static bool lookup(time_t day_start, long out[12], bool allow_reparse, bool &found) {
+    std::fill(out, out + 12, 0);
+    found = false;
+    unsigned int epoch;
+
+    // 1. 命中：移到链表头部
+    {
+        std::lock_guard<std::mutex> lock(s_cache_mutex);
+        auto it = s_index.find(day_start);
+        if (it != s_index.end()) {
+            s_lru.splice(s_lru.begin(), s_lru, it->second);
+            std::copy(it->second->buckets->sec, it->second->buckets->sec + 12, out);
+            s_cache_hits++;
+            found = true;
+            return true;
+        }
+        epoch = s_cache_epoch;
+        s_cache_misses++;
+    }
+
+    // 2. 未命中：当天没有阅读记录就不必读盘
+    StatsRef stats = stats_current();
+    if (stats->history_map.find(day_start) == stats->history_map.end()) {
+        return true;
+    }
+
+    // 3. 优先从快照读回，快照与当前数据不同源时退回到重新解析日志
+    DayBuckets b;
+    if (load_snapshot_day_detail(stats->source, day_start, b)) {
+        found = true;
+    } else if (!allow_reparse) {
+        return false;
+    } else {
+        found = reparse_day_detail(day_start, b);
+    }
+    if (!found) return true;
+    std::copy(b.sec, b.sec + 12, out);
+
+    // 读盘期间缓存被重建过的话，结果可能不是最新版本，不再放回
+    std::lock_guard<std::mutex> lock(s_cache_mutex);
+    if (epoch == s_cache_epoch && s_index.find(day_start) == s_index.end()) {
+        insert_front(day_start, b);
+    }
+    return true;
+}
+
+bool detail_cache_get(time_t day_start, long out[12]) {
+    bool found;
+    lookup(day_start, out, true, found);
+    return found;
+}
+
+bool detail_cache_peek(time_t day_start, long out[12]) {
+    bool found;
+    return lookup(day_start, out, false, found);
+}
+
+void detail_cache_report(FILE *fp) {
+    std::lock_guard<std::mutex> lock(s_cache_mutex);
+    size_t cap = s_arena.capacity();
+    double frag = cap ? 100.0 * (cap - s_arena.live()) / cap : 0.0;
+
+    fprintf(fp, "  detail cache : %zu days, %zu B (index %zu B, arena %zu B in %zu blocks), budget %zu B\n",
+            s_lru.size(), cache_bytes_locked(), s_lru.size() * DETAIL_INDEX_COST,
+            s_arena.reserved_bytes(), s_arena.block_count(), detail_cache_budget());
+    fprintf(fp, "  arena        : %zu live / %zu slots, %zu on free list, %.1f%% unused\n",
+            s_arena.live(), cap, s_arena.free_count(), frag);
+    fprintf(fp, "  lookups      : %zu hits, %zu misses\n", s_cache_hits, s_cache_misses);
+}
@@ -0,0 +1,133 @@
+#ifndef BUCKETSTORE_HPP
+#define BUCKETSTORE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <string>
+#include <vector>
+
+// —— 紧凑分桶存储 ——
+// 一天 12 个 2 小时桶，每桶最多 7200 秒，uint16 足够 (24 字节/天，
+// 原先的 std::vector<long> 在 64 位上是 96 字节数据 + 24 字节头 + 一次堆分配)
+
+struct DayBuckets {
+    uint16_t sec[12];
+};
+
+// 定长记录池：按块一次分配多天的记录，释放的记录挂到空闲链表上复用
+class BucketArena {
+public:
+    explicit BucketArena(size_t days_per_block = 64);
+    ~BucketArena();
+    BucketArena(const BucketArena &) = delete;
+    BucketArena& operator=(const BucketArena &) = delete;
+
+    // 返回清零的记录
+    DayBuckets* alloc();
+    void release(DayBuckets *b);
+    // 释放所有块
+    void clear();
+
+    // 不分配新块就能再放下一条记录
+    bool has_free() const;
+
+    size_t live() const { return live_; }
+    size_t free_count() const { return free_count_; }
+    size_t capacity() const { return blocks_.size() * per_block_; }
+    size_t block_count() const { return blocks_.size(); }
+    size_t block_bytes() const { return per_block_ * sizeof(DayBuckets); }
+    size_t reserved_bytes() const { return blocks_.size() * block_bytes(); }
+
+private:
+    std::vector<DayBuckets *> blocks_;
+    size_t per_block_;
+    size_t used_in_last_;    // 最后一块中已切出的记录数
+    DayBuckets *free_list_;  // 空闲记录的前 8 字节存放下一条空闲记录
+    size_t free_count_;
+    size_t live_;
+};
+
+struct DetailSpillRecord;
+
+// 每日分桶详情：按日期排序的索引 + 记录池
+// 设置了常驻窗口后只在内存中保留最近的若干天，更早的记录写到临时文件，
+// 由 DetailReader 按日期合并读出。全量解析十年的日志时内存占用也不超过窗口
+class DetailMap {
+public:
+    typedef std::map<time_t, DayBuckets *> Index;
+
+    DetailMap() : window_(0), spill_(NULL), spilled_(0) {}
+    ~DetailMap();
+    DetailMap(const DetailMap &) = delete;
+    DetailMap& operator=(const DetailMap &) = delete;
+
+    // 最多常驻 max_days 天，超出时把最早的一天追加到临时文件
+    // (spill_template 是 mkstemp 模板，文件建好后立即 unlink)。
+    // 临时文件建不起来时返回 false，记录仍全部常驻
+    bool set_window(size_t max_days, const std::string &spill_template);
+
+    // 取某一天的记录，不存在时新建 (清零)
+    DayBuckets& operator[](time_t day_start);
+    // 按日期升序追加 (读快照时使用，O(1))
+    DayBuckets& append(time_t day_start);
+    const DayBuckets* find(time_t day_start) const;
+    void clear();
+
+    size_t size() const { return index_.size(); }
+    Index::const_iterator begin() const { return index_.begin(); }
+    Index::const_iterator end() const { return index_.end(); }
+    Index::const_reverse_iterator rbegin() const { return index_.rbegin(); }
+    Index::const_reverse_iterator rend() const { return index_.rend(); }
+    const BucketArena& arena() const { return arena_; }
+    // 已写到临时文件的记录数 (同一天可能有多条)
+    size_t spilled() const { return spilled_; }
+
+private:
+    friend class DetailReader;
+    void spill_oldest();
+
+    BucketArena arena_;
+    Index index_;
+    size_t window_;
+    FILE *spill_;
+    size_t spilled_;
+};
+
+// 按日期升序合并读出 DetailMap 的全部记录 (常驻的与临时文件中的)。
+// 构造时把临时文件映射进来原地排序，不额外占用堆内存
+class DetailReader {
+public:
+    explicit DetailReader(DetailMap &details);
+    ~DetailReader();
+    DetailReader(const DetailReader &) = delete;
+    DetailReader& operator=(const DetailReader &) = delete;
+
+    // 把 day_start 的分桶累加到 out。必须按日期升序调用，跳过的日期不再读出
+    void add_to(time_t day_start, DayBuckets &out);
+
+private:
+    const DetailMap &details_;
+    DetailMap::Index::const_iterator it_;
+    DetailSpillRecord *spill_;
+    size_t spill_count_;
+    size_t spill_pos_;
+    size_t map_len_;
+    std::vector<char> fallback_;    // 映射失败时整块读入内存
+};
+
+// 向桶中累加秒数 (饱和到 uint16 上限，重叠的异常日志不会回绕)
+inline void add_bucket_seconds(DayBuckets &b, int idx, long sec) {
+    long v = (long)b.sec[idx] + sec;
+    b.sec[idx] = (uint16_t)(v > UINT16_MAX ? UINT16_MAX : v);
+}
+
+// std::map 单个节点的估算大小 (红黑树节点头 + 值)
+template <typename M>
+inline size_t map_node_bytes() {
+    return 4 * sizeof(void *) + sizeof(typename M::value_type);
+}
+
+#endif
@@ -3,9 +3,13 @@
 #include <gtk/gtk.h>
 #include "types.hpp"
 
+void render_today_dist(cairo_t *cr, const ViewData &v, int w, int h);
 gboolean draw_today_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data);
 void update_daily_view_ui(DailyViewWidgets *dv);
 void on_daily_change(GtkButton *btn, gpointer data);
+void show_daily_view(time_t day_ts);
+// 当前日期的分桶已被淘汰时在后台线程读取，取到后刷新日视图
+void daily_view_load_pending();
 
 GtkWidget* create_today_page();
 
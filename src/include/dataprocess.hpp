@@ -3,17 +3,45 @@
 
 #include <string>
 #include <ctime>
+#include <atomic>
+#include <vector>
 
 #include "types.hpp"
+#include "bucketstore.hpp"
 
-void parse_line_and_update(char *line, Stats &s, 
-                                  time_t today_start, time_t tomorrow_start,
-                                  time_t week_start, time_t week_end,
-                                  time_t cur_month_start, time_t cur_month_end);
+void parse_line_and_update(char *line, Stats &s, DetailMap &details);
 
 
 void preprocess_data();
-void refresh_daily_view_data(Stats &s, time_t target_day_ts);
-void read_logs_and_compute_stats(Stats &s, int view_year, int view_month, bool force_reload);
+
+// 后台读取的进度与取消标志：工作线程写，UI 线程读
+struct LoadProgress {
+    std::atomic<bool> preparing;        // 正在合并/解压归档，尚未开始解析
+    std::atomic<long long> bytes_done;
+    std::atomic<long long> bytes_total;
+    std::atomic<long> records;
+    std::atomic<bool> cancel;
+
+    LoadProgress() : preparing(false), bytes_done(0), bytes_total(0), records(0), cancel(false) {}
+};
+
+// Stats 版本：任意线程可读，发布为原子替换
+StatsRef stats_current();
+void stats_publish(StatsRef s);
+StatsRef build_stats(LoadProgress *progress = NULL);
+void publish_cached_stats();
+bool reparse_day_detail(time_t day_start, DayBuckets &out);
+void print_memory_report();
+
+void refresh_daily_view_data(ViewData &v, time_t target_day_ts);
+void set_daily_view_data(ViewData &v, const long buckets[12], bool pending = false);
+void compute_week_days(const Stats &s, time_t week_start, long out[7]);
+void refresh_week_view_data(ViewData &v, const Stats &s, time_t week_start);
+void set_week_view_data(ViewData &v, time_t week_start, const long days[7]);
+void compute_month_days(const Stats &s, int view_year, int view_month, std::vector<long> &out);
+void refresh_month_view_data(ViewData &v, const Stats &s, int view_year, int view_month);
+void set_month_view_data(ViewData &v, int view_year, int view_month, const std::vector<long> &days,
+                         int target_minutes);
+void refresh_view_data(ViewData &v, int view_year, int view_month);
 
 #endif
\ No newline at end of file
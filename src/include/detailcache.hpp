@@ -0,0 +1,35 @@
+#ifndef DETAILCACHE_HPP
+#define DETAILCACHE_HPP
+
+#include <ctime>
+#include <cstddef>
+#include <cstdio>
+
+#include "types.hpp"
+#include "bucketstore.hpp"
+#include "snapshot.hpp"
+
+// —— 分桶详情 LRU 缓存 ——
+// 每日总数始终常驻在 Stats 中，而 12 桶分时详情只在日视图用到。
+// 常驻详情受 g_detail_cache_kib 限制，超出预算时淘汰最久未访问的日期，
+// 再次访问时从快照 (或源日志) 按需读回
+
+// 用新构建的详情替换缓存内容，只保留预算内最近的日期
+void detail_cache_reset(DetailMap &&details);
+// 同上，从快照文件中读入最近的日期；快照无效时清空缓存
+void detail_cache_reset(const SnapshotFile &snap);
+// 预算内大约能放下的天数 (0 表示不限制)，解析日志时常驻的分桶也以此为上限
+size_t detail_cache_day_capacity();
+// 取某一天的分桶，没有阅读记录时 out 全为 0 并返回 false
+bool detail_cache_get(time_t day_start, long out[12]);
+// 同上，但只用缓存和快照，不重新解析日志 (可能要解压整个归档)。
+// 返回 true 时 out 有效 (包括当天没有阅读记录)；只能靠解析日志得到时返回 false
+bool detail_cache_peek(time_t day_start, long out[12]);
+
+// 当前常驻字节数 (估算) 与预算 (0 表示不限制)
+size_t detail_cache_bytes();
+size_t detail_cache_budget();
+// 打印记录数、各部分字节数与记录池碎片率 (调试用)
+void detail_cache_report(FILE *fp);
+
+#endif
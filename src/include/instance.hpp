@@ -0,0 +1,26 @@
+#ifndef INSTANCE_HPP
+#define INSTANCE_HPP
+
+// —— 单实例 ——
+// 第一个实例在 Unix 域套接字上监听；再次启动时只把请求转交给它
+// (前台显示 + 增量刷新) 然后退出，不再杀掉正在运行的进程
+
+typedef void (*InstanceActivateFunc)();
+
+enum InstanceHandoff {
+    INSTANCE_NONE,          // 没有运行中的实例 (遗留的套接字文件已删除)，正常启动
+    INSTANCE_ACTIVATED,     // 已有实例确认了请求
+    INSTANCE_BUSY           // 已有实例在监听但迟迟没有应答，请求仍排在它的队列里
+};
+
+// 把请求转交给已有实例。返回 INSTANCE_NONE 以外的值时调用方应直接退出，
+// 不能再启动第二个实例去抢同一块屏幕
+InstanceHandoff instance_handoff_to_existing();
+// 开始监听，收到请求时在 UI 线程调用 on_activate。套接字被其他实例占用时返回 false
+bool instance_listen(InstanceActivateFunc on_activate);
+// 收到 SIGTERM/SIGINT/SIGHUP 时退出主循环，使正常的清理流程得以执行
+void instance_install_quit_signals();
+// 关闭并删除套接字文件
+void instance_shutdown();
+
+#endif
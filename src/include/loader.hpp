@@ -0,0 +1,24 @@
+#ifndef LOADER_HPP
+#define LOADER_HPP
+
+#include "types.hpp"
+#include "dataprocess.hpp"
+
+// —— 后台数据加载 ——
+// 在工作线程中执行 preprocess_data + build_stats，UI 线程不再被日志解析阻塞。
+// 进度由主循环定时读取，结果通过 g_idle_add 回到 UI 线程，由 on_done 负责发布
+
+typedef void (*LoaderProgressFunc)(const LoadProgress &progress);
+typedef void (*LoaderDoneFunc)(StatsRef stats);
+
+// 已有加载在进行时返回 false
+bool loader_start(LoaderProgressFunc on_progress, LoaderDoneFunc on_done);
+// 请求取消并等待工作线程退出 (退出程序前调用)，被取消的结果不会回调 on_done
+void loader_cancel_and_wait();
+// 取消进行中的加载 (结果作废)，用上次 loader_start 的回调重新全量读取。
+// 不阻塞：旧线程退出后才开始新一轮。清除数据后使用，进度显示与取消同样有效；
+// 从未启动过时返回 false
+bool loader_restart();
+bool loader_running();
+
+#endif
@@ -6,8 +6,11 @@
 #include "utils.hpp"
 
 double get_gray_level_16(double ratio);
+void render_month_view(cairo_t *cr, const ViewData &v, int w, int h);
 gboolean draw_month_view(GtkWidget *widget, GdkEventExpose *event, gpointer data);
 void update_month_title(MonthViewWidgets *mv);
+// 数据刷新后只重绘变化的格子
+void month_view_data_changed();
 
 void month_prev(GtkButton *b, gpointer data);
 void month_next(GtkButton *b, gpointer data);
@@ -0,0 +1,23 @@
+#ifndef NAVSCHED_HPP
+#define NAVSCHED_HPP
+
+#include <gtk/gtk.h>
+
+// —— 翻页合并 ——
+// 连续点击翻页时，标题等轻量内容每次立即更新，数据计算和重绘推迟到点击停下后
+// 只做一次，墨水屏上不会刷出中间的每一页。绘制期间排队的点击同样被合并
+
+typedef void (*NavCommitFunc)(gpointer data);
+
+struct NavScheduler {
+    guint source;
+    NavCommitFunc commit;
+    gpointer data;
+};
+
+// 记录一次翻页请求：重新开始计时，停止点击 250ms 后调用 commit(data)
+void nav_request(NavScheduler &ns, NavCommitFunc commit, gpointer data);
+// 丢弃尚未提交的请求 (调用方会自行刷新到新的目标)
+void nav_cancel(NavScheduler &ns);
+
+#endif
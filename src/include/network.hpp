@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <pthread.h>
+
+typedef void CURL;
 
 struct UserInfo {
     std::string nickname;
@@ -52,7 +55,16 @@ public:
     std::string get_last_sync_text() const;
 
 private:
-    KykkyNetwork() {}
+    KykkyNetwork() : curl_(nullptr) { pthread_mutex_init(&curl_mutex_, NULL); }
+
+    // 第一次发起请求前调用，执行 curl_global_init
+    static void ensure_curl();
+
+    // 取得复用的 easy handle 并独占，用完必须 release_curl (handle 可能为空)
+    CURL* acquire_curl();
+    void release_curl();
+    CURL *curl_;
+    pthread_mutex_t curl_mutex_;
 
     void save_state();
     void load_state();
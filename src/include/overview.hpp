@@ -2,8 +2,11 @@
 #define OVERVIEW_HPP
 
 #include <gtk/gtk.h>
+#include "dataprocess.hpp"
 
 GtkWidget* create_overview_page();
+void update_overview_page();
+void update_overview_progress(const LoadProgress &progress);
 
 
 #endif
\ No newline at end of file
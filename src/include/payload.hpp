@@ -0,0 +1,62 @@
+#ifndef PAYLOAD_HPP
+#define PAYLOAD_HPP
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+// —— 分享与快速同步的紧凑编码 ——
+// 返回原始字节，放进链接时再做 base64url (见 base64url_encode)。
+//
+// 解码规范 (版本 1)：
+//
+//   首字节    高 4 位为类型，低 4 位为版本号 (当前为 1)，版本不认识时拒绝解析
+//   uint      无符号 LEB128 变长整数：每字节低 7 位为数据，低位组在前，最高位 1 表示后面还有
+//   str       uint 字节数 + UTF-8 内容
+//   series    uint 天数 n，随后 ceil(n/8) 字节的位图 (第 i 天对应第 i/8 字节的第 i%8 位，
+//             最低位在前)，位为 1 的天按顺序各跟一个 uint 分钟数；位为 0 的天为 0 分钟
+//
+//   类型 1  月度分享    uint 年, uint 月, uint 每日目标分钟, series 每日, series 分时 (12 段)
+//   类型 2  快速同步    str 设备码, uint 今日秒数, uint 本月秒数
+//   类型 3  年度分享    uint 年, uint 每日目标分钟, series 每日 (自 1 月 1 日起)
+//   类型 4  历史同步    str 设备码, uint 起始日 (本地日期距 1970-01-01 的天数), series 每日
+//
+// 分钟数由秒数向上取整。series 按秒数传入
+
+enum PayloadKind {
+    PAYLOAD_MONTH_SHARE = 1,
+    PAYLOAD_FAST_SYNC = 2,
+    PAYLOAD_YEAR_SHARE = 3,
+    PAYLOAD_HISTORY = 4
+};
+
+extern const int PAYLOAD_VERSION;
+
+std::string payload_month_share(int year, int month, int goal_minutes,
+                                const std::vector<long> &day_seconds, const long buckets[12]);
+std::string payload_fast_sync(const std::string &device_code, long today_seconds, long month_seconds);
+std::string payload_year_share(int year, int goal_minutes, const std::vector<long> &day_seconds);
+std::string payload_history(const std::string &device_code, time_t first_day,
+                            const std::vector<long> &day_seconds);
+
+// 解码结果，只填写该类型用到的字段；series 还原为分钟数
+struct DecodedPayload {
+    PayloadKind kind;
+    int year;
+    int month;
+    int goal_minutes;
+    std::string device_code;
+    long today_seconds;
+    long month_seconds;
+    long first_epoch_day;
+    std::vector<long> day_minutes;
+    std::vector<long> bucket_minutes;
+
+    DecodedPayload() : kind(PAYLOAD_MONTH_SHARE), year(0), month(0), goal_minutes(0),
+                       today_seconds(0), month_seconds(0), first_epoch_day(0) {}
+};
+
+// 按上面的规范解析原始字节 (base64url 解码之后)。版本不认识、截断或有多余字节时返回 false
+bool payload_decode(const std::string &data, DecodedPayload &out);
+
+#endif
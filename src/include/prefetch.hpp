@@ -0,0 +1,24 @@
+#ifndef PREFETCH_HPP
+#define PREFETCH_HPP
+
+#include <functional>
+
+// —— 空闲预取 ——
+// 翻页后在空闲时准备相邻页面的数据和图表，下次翻页直接换图。
+// 任务以低于输入事件的优先级逐个执行，每轮有时间预算，有待处理的事件时立刻让出。
+// 只在 UI 线程使用
+
+enum PrefetchGroup {
+    PREFETCH_DAY,
+    PREFETCH_MONTH,
+    PREFETCH_GROUP_COUNT
+};
+
+typedef std::function<void()> PrefetchTask;
+
+// 追加一个任务
+void prefetch_add(PrefetchGroup group, PrefetchTask task);
+// 取消该组尚未执行的任务 (翻页后旧的相邻页已无意义)
+void prefetch_cancel(PrefetchGroup group);
+
+#endif
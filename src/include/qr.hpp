@@ -0,0 +1,40 @@
+#ifndef QR_HPP
+#define QR_HPP
+
+#include <gtk/gtk.h>
+#include <cairo.h>
+#include <memory>
+#include <string>
+
+// —— 二维码编码与绘制 ——
+// 编码结果按内容缓存，同一内容只编码一次；编码放在后台线程，
+// 绘制时把每模块 1 像素的 A8 蒙版按整数倍最近邻放大，一次贴图完成
+
+struct QrSymbol {
+    std::string text;
+    int size;                   // 每边模块数，编码失败时为 0
+    cairo_surface_t *mask;      // A8，每模块 1 像素，深色模块不透明
+
+    QrSymbol() : size(0), mask(NULL) {}
+    ~QrSymbol();
+    QrSymbol(const QrSymbol&) = delete;
+    QrSymbol& operator=(const QrSymbol&) = delete;
+};
+
+typedef std::shared_ptr<const QrSymbol> QrRef;
+
+// 取得 text 的二维码，未缓存时在当前线程编码。线程安全
+QrRef qr_encode(const std::string &text);
+// 编码但不放入缓存，由调用方自己持有 (多帧序列帧数多，放进缓存会挤掉其它二维码)
+QrRef qr_encode_uncached(const std::string &text);
+// 只查缓存，未编码过时返回空
+QrRef qr_lookup(const std::string &text);
+
+// 以当前 source 颜色把二维码画进 (x, y) 起、边长 side 的正方形 (居中)
+void qr_paint(cairo_t *cr, const QrSymbol &qr, double x, double y, double side);
+
+// 显示 text 二维码的控件，边长 side 像素，二维码占 80% 并居中。
+// 未缓存时先显示空白，后台编码完成后自动重绘
+GtkWidget* qr_widget_new(const std::string &text, int side);
+
+#endif
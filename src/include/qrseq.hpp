@@ -0,0 +1,45 @@
+#ifndef QRSEQ_HPP
+#define QRSEQ_HPP
+
+#include <gtk/gtk.h>
+#include <string>
+#include <vector>
+
+// —— 多帧二维码 ——
+// 单个二维码装不下的内容 (全年分享、全部历史离线同步) 拆成多帧轮播，
+// 手机端连续扫描后拼回原文。
+//
+// 帧格式 (每帧一个二维码)：
+//
+//   <prefix><seq>/<k>/<len>/<crc>/<data>
+//
+//   prefix  调用方给定，一般是接收页地址加 '#'，扫到任意一帧都能打开接收页
+//   seq     帧号，十进制，从 0 开始
+//   k       数据块数
+//   len     原文字节数
+//   crc     原文 CRC-32 (IEEE 802.3，同 zlib)，8 位小写十六进制
+//   data    该帧内容的 base64url (无 '=' 补齐)
+//
+// 原文按 QRSEQ_CHUNK_BYTES 切成 k 块，最后一块补 0 到等长。
+// seq < k 的帧就是第 seq 块；seq >= k 的是校验帧，内容为若干块的按字节异或，
+// 参与的块号由 seq 决定：
+//
+//   x = (seq * 0x9E3779B1) mod 2^32，为 0 时取 1
+//   next(): x ^= x << 13; x ^= x >> 17; x ^= x << 5; 返回 x (均为 32 位无符号运算)
+//   度数 d = min(2 + next() % 2, k)
+//   反复取 next() % k，跳过已选的块号，直到选够 d 个
+//
+// 接收端收齐 k 块即完成；缺块时用校验帧消元：已知块异或掉后只剩一个未知块的校验帧
+// 直接解出该块，重复直到没有进展。拼好后截到 len 字节并校验 crc。
+
+// 每帧承载的原文字节数，编码后约为 QR 版本 9 (ECC LOW)
+extern const size_t QRSEQ_CHUNK_BYTES;
+
+// 把 payload 拆成帧文本：k 个数据帧加约 k/2 个校验帧 (k 为 1 时不加)
+std::vector<std::string> qr_split_frames(const std::string &prefix, const std::string &payload);
+
+// 轮播 frames 的控件，边长 side 像素。
+// 所有帧在后台线程预先编码，轮播时只贴图；尚未编码完的帧先跳过
+GtkWidget* qr_sequence_widget_new(const std::vector<std::string> &frames, int side);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef RENDER_HPP
+#define RENDER_HPP
+
+#include <gtk/gtk.h>
+#include <cairo.h>
+#include <vector>
+#include "types.hpp"
+
+// —— 图表离屏缓存 ——
+// 图表先画到与窗口兼容的离屏 surface，expose 时只做一次贴图。
+// 尺寸或数据版本变化时才重新绘制。
+// 配置 gray_render=1 时改用 8 位灰度 surface，贴图时作为蒙版印到白底上
+
+// 在 (0,0)-(w,h) 范围内按 v 完整绘制一张图表
+typedef void (*ChartRenderFunc)(cairo_t *cr, const ViewData &v, int w, int h);
+
+struct ChartCache {
+    cairo_surface_t *surface;
+    int width;
+    int height;
+    unsigned int version;
+    bool gray;          // surface 是否为 A8 灰度模式
+};
+
+// expose 回调中使用：缓存有效时直接贴图，否则先按 g_view_data 调用 render 重建
+void chart_cache_paint(ChartCache &cache, GtkWidget *widget, GdkEventExpose *event,
+                       unsigned int version, ChartRenderFunc render);
+// 图表统一用灰度值 (0=黑，1=白) 设置颜色。
+// g_gray_render 打开时图表画在 A8 surface 上，这里改为写入量化后的墨量
+void set_gray(cairo_t *cr, double gray);
+
+// 丢弃缓存的 surface
+void chart_cache_reset(ChartCache &cache);
+
+// 不经过 expose，按 v 为 widget 预先画一张图表 (用于翻页预取)。widget 尚未显示时返回 false
+bool chart_cache_prerender(ChartCache &img, GtkWidget *widget, const ViewData &v, ChartRenderFunc render);
+// 把预先画好的 img 换入 cache 并标记为 version，下次 expose 直接贴图。
+// 尺寸或绘制模式已经变化时丢弃 img 并返回 false
+bool chart_cache_adopt(ChartCache &cache, ChartCache &img, GtkWidget *widget, unsigned int version);
+
+// —— 按灰度批量填充 ——
+// 日历和热力图的格子只有 16 种灰度，同一灰度的矩形合成一条路径一次填充。
+// 与逐个填充的区别只在相邻同灰度格子共用的边缘像素：逐个填充时两次抗锯齿叠加会透出底色，
+// 合并后按并集计算覆盖率，没有这道浅色接缝。灰度模式关闭抗锯齿，两种方式结果相同
+struct GrayRect {
+    double gray;
+    double x, y, w, h;
+};
+
+// 按灰度排序后分批填充 (会重排 rects)
+void fill_rects_by_gray(cairo_t *cr, std::vector<GrayRect> &rects);
+// 关闭后 fill_rects_by_gray 逐个矩形填充 (绘制基准用，默认开启)
+void fill_rects_set_batched(bool batched);
+
+#endif
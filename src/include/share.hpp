@@ -4,9 +4,17 @@
 #include <gtk/gtk.h>
 #include <string>
 #include <ctime>
+#include <vector>
 
 std::string generate_share_url();
-gboolean draw_qrcode(GtkWidget *widget, GdkEventExpose *event, gpointer data);
+// 离线快速同步：今日与本月的秒数
+std::string generate_fast_sync_url(const std::string &device_code);
+
+// 多帧二维码的帧文本 (格式见 qrseq.hpp)
+// 当前查看年份每天的分钟数
+std::vector<std::string> generate_year_share_frames();
+// 全部历史每天的分钟数，用于离线同步
+std::vector<std::string> generate_history_sync_frames(const std::string &device_code);
 
 void create_share_dialog();
 
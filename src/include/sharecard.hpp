@@ -0,0 +1,31 @@
+#ifndef SHARECARD_HPP
+#define SHARECARD_HPP
+
+#include <gtk/gtk.h>
+#include <cairo.h>
+#include <string>
+#include <ctime>
+
+#include "types.hpp"
+
+// —— 分享图片 ——
+// 把月历、当日分布和关键数字拼成一张 PNG，保存到 Kindle 的 documents 目录。
+// 数据在 UI 线程拷贝一份，绘制和写文件在后台线程完成，使用与各页面相同的绘制函数
+
+struct ShareCardData {
+    ViewData view;          // 月份与当日分布
+    time_t day;             // view 中分布数据对应的日期
+    int target_minutes;
+    std::string share_url;  // 印在图片角落的二维码内容
+};
+
+// 绘制整张分享图片
+void render_share_card(cairo_t *cr, const ShareCardData &d, int w, int h);
+
+// 导出完成后在 UI 线程回调；失败时 path 为空
+typedef void (*ShareCardDoneFunc)(const std::string &path, gpointer data);
+
+// 以当前视图数据生成分享图片 (1072×1448，与屏幕一致)，立即返回
+void share_card_export_async(ShareCardDoneFunc done, gpointer data);
+
+#endif
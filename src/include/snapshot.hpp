@@ -0,0 +1,49 @@
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+
+#include "types.hpp"
+#include "bucketstore.hpp"
+
+// —— Stats 持久化快照 ——
+// 将聚合结果 (每日总数、分桶、月汇总) 写成带版本号的二进制文件，
+// 启动时 mmap 读回，只需再解析快照之后新增的日志
+
+// 映射到内存的快照文件，析构时解除映射。分桶详情直接从映射中读取，不整体载入
+class SnapshotFile {
+public:
+    SnapshotFile() : map_(NULL), len_(0) {}
+    ~SnapshotFile();
+    SnapshotFile(const SnapshotFile &) = delete;
+    SnapshotFile& operator=(const SnapshotFile &) = delete;
+
+    // 映射 SNAPSHOT_FILE 并校验头部与长度，verify_checksum 时再校验记录区
+    bool open(bool verify_checksum);
+    void close();
+    bool valid() const { return map_ != NULL; }
+    // 快照是否由 src 描述的源文件状态生成
+    bool same_source(const StatsSource &src) const;
+
+    // 按日期升序的第 i 天
+    size_t day_count() const;
+    time_t day_at(size_t i) const;
+    void buckets_at(size_t i, DayBuckets &out) const;
+    bool find_day(time_t day_start, DayBuckets &out) const;
+
+private:
+    friend bool load_stats_snapshot(Stats &s, SnapshotFile *keep);
+    const void *map_;
+    size_t len_;
+};
+
+// 读取快照中的每日/每月总数与源文件状态到 s。文件缺失、版本不符或校验失败时返回 false。
+// keep 非空时保留映射，供之后读取分桶或作为 save_stats_snapshot 的 base
+bool load_stats_snapshot(Stats &s, SnapshotFile *keep = NULL);
+// 原子写入快照 (先写临时文件再 rename)。
+// base 非空时 details 只含 base 之后新解析的部分，每天的分桶为两者之和
+bool save_stats_snapshot(const Stats &s, DetailMap &details, const SnapshotFile *base);
+// 只读取某一天的分桶。快照与 expect 不同源或没有该日期时返回 false
+bool load_snapshot_day_detail(const StatsSource &expect, time_t day_start, DayBuckets &out);
+// 日志 path 中 offset 之前一段内容的校验和，写入 StatsSource::log_check
+unsigned int log_checkpoint_sum(const std::string &path, long long offset);
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+// —— 启动阶段追踪 ——
+// 设置环境变量 KYKKY_TRACE 后启用：值为文件路径时写到该文件，
+// 为 1 时写到 /tmp/kykky_trace.json (Chrome trace_event 格式，可在 chrome://tracing 打开)。
+// 未启用时各函数只检查一次标志位
+
+// 读取环境变量并记录起始时间，应在 main 开头调用
+void trace_init();
+bool trace_enabled();
+
+// 记录一个瞬时事件 (例如首帧绘制)
+void trace_instant(const char *name);
+
+// 启动完成：打印总耗时与各阶段耗时汇总，并写出 trace 文件
+void trace_startup_done();
+// 把目前为止的所有事件写到 trace 文件 (退出时再调用一次，包含启动后的页面构建等)
+void trace_flush();
+
+// 作用域计时：构造时开始，析构时结束。name 必须是字符串常量
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name);
+    ~TraceSpan();
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan& operator=(const TraceSpan &) = delete;
+
+private:
+    const char *name_;
+    long long start_us_;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(name)
+
+#endif
@@ -5,32 +5,78 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <memory>
+
+// —— 统计数据来源 ——
+// 记录 Stats 是基于哪些源文件状态算出来的，用于校验持久化快照
+struct StatsSource {
+    long long archive_size;       // history.gz 大小，-1 表示不存在
+    long long archive_mtime;
+    long long log_offset;         // 当月日志已读入的字节数 (检查点)
+    unsigned int log_check;       // 检查点之前一段内容的校验和，确认仍是同一个文件 (见 log_checkpoint_sum)
+    char log_name[32];            // 当月日志文件名
+};
 
 // —— 统计结构 ——
+// 日志聚合结果。一经发布即不可修改，各线程通过 StatsRef 共享同一版本，
+// 重读日志时构造新版本再整体替换 (见 stats_publish)
 struct Stats {
     long total_seconds;
     long today_seconds;
     long week_seconds;
     long month_seconds;
 
+    // 每日总秒数map
+    std::map<time_t, long> history_map;
+    // 每月总秒数map，key = 年 * 100 + 月
+    std::map<int, long> month_map;
+
+    // 本版本对应的源文件状态
+    StatsSource source;
+
+    // 版本号，每次重读日志后递增；0 表示尚未加载
+    unsigned int generation;
+
+    // 直接取自上次保存的快照，尚未解析新日志 (启动时先用它绘制界面)
+    bool provisional;
+};
+
+typedef std::shared_ptr<const Stats> StatsRef;
+
+// —— 视图数据 ——
+// 由当前 Stats 版本派生的各页面显示数据，只在 UI 线程读写
+struct ViewData {
     long view_daily_seconds;      // 当前查看日期的总秒数
     long view_daily_buckets[12];  // 当前查看日期的分布桶
+    bool view_daily_pending;      // 分桶已被淘汰、正在后台重新读取 (此时分桶全为 0)
 
-    long week_days[7];      // 周一到周日
+    time_t view_week_start;       // 当前查看周的周一 0 点
+    long view_week_days[7];       // 当前查看周：周一到周日
+    long view_week_seconds;       // 当前查看周的总秒数
+    bool view_week_is_current;    // 是否为本周 (决定 "本周/这周" 的文字)，随日期变化
 
     std::vector<long> month_day_seconds;
     int month_year;
     int month_month;
+    int month_target_minutes;     // 月历灰度的基准 (每日目标)，与数据一起拷贝给后台绘制
 
-    // 每日总秒数map
-    std::map<time_t, long> history_map;
-    // 每日分桶详情map
-    std::map<time_t, std::vector<long>> daily_detail_map;
-
-    // 标记数据是否已加载
-    bool loaded;
+    // 各图表数据的版本号，内容真正变化时递增，用于判断离屏缓存是否过期
+    unsigned int daily_version;
+    unsigned int week_version;
+    unsigned int month_version;
 };
 
+// 用于概览页的控件包
+typedef struct {
+    GtkWidget *label_provisional;   // 数据未更新完成时的提示
+    GtkWidget *progress_bar;        // 后台读取日志的进度
+    GtkWidget *label_target_status;
+    GtkWidget *label_today_time;
+    GtkWidget *label_total_time;
+    GtkWidget *label_consecutive;
+    GtkWidget *label_month_target;
+} OverviewWidgets;
+
 // 用于日视图的控件包
 typedef struct {
     GtkWidget *drawing_area;
@@ -39,12 +85,24 @@ typedef struct {
     GtkWidget *label_date;       // 显示 "10月27日"
 } DailyViewWidgets;
 
+// 用于周视图的控件包
+typedef struct {
+    GtkWidget *drawing_area;
+    GtkWidget *label_title;
+} WeekViewWidgets;
+
 // 用于月视图的控件包
 typedef struct {
     GtkWidget *drawing_area;
     GtkWidget *label_title;
 } MonthViewWidgets;
 
+// 用于年度热力图的控件包
+typedef struct {
+    GtkWidget *drawing_area;
+    GtkWidget *label_title;
+} YearViewWidgets;
+
 struct UIHandles {
     GtkWidget *lbl_settings_cloud_status; // 设置页：“尚未登录/已连接”
     GtkWidget *lbl_overview_sync_time;   // 概览页底部：“上次同步：12:00”
@@ -60,6 +118,8 @@ extern const std::string ARCHIVE_FILE;
 extern const std::string CONFIG_FILE;
 extern const std::string ETC_TOKEN_FILE;
 extern const std::string STATE_FILE;
+extern const std::string SNAPSHOT_FILE;
+extern const std::string SHARE_CARD_DIR;
 
 extern const char *LOG_PREFIX; 
 extern const char *TEMP_LOG_FILE;
@@ -67,17 +127,22 @@ extern const char *TEMP_LOG_FILE;
 extern const int DEFAULT_TARGET_MINUTES;
 extern const int MIN_TARGET_MINUTES;
 extern const int MAX_TARGET_MINUTES;
+extern const int DEFAULT_DETAIL_CACHE_KIB;
 
 // 声明全局变量
 extern int g_daily_target_minutes;
 extern std::string g_share_domain;
+extern int g_detail_cache_kib;
+extern bool g_gray_render;
 extern GdkColor white;
 extern GdkColor gray;
 
-extern Stats g_stats;
+extern ViewData g_view_data;
 extern int g_view_year;
 extern int g_view_month;
 extern time_t g_view_daily_ts;
+extern time_t g_view_week_start;
+extern int g_view_heatmap_year;
 
 extern UIHandles g_ui_handles;
 extern GtkWidget *g_notebook;
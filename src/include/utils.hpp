@@ -8,6 +8,7 @@
 time_t get_day_start(time_t t);
 void get_today_bounds(time_t &today_start, time_t &tomorrow_start);
 void get_week_start(time_t &week_start);
+time_t add_days(time_t day_start, int n);
 void get_month_start(time_t &month_start, int &year, int &month);
 int days_in_month(int y, int m);
 void format_hms(long sec, char *buf, size_t sz);
@@ -18,6 +19,8 @@ void refresh_all_status_labels();
 
 
 std::string base64_encode(const std::string& in);
+// URL 安全字母表 (-_)，不补 '='
+std::string base64url_encode(const std::string& in);
 
 // 配置管理
 void save_target_config();
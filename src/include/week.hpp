@@ -4,8 +4,16 @@
 #include <string>
 #include <ctime>
 #include <gtk/gtk.h>
+#include "types.hpp"
 
+void render_week_dist(cairo_t *cr, const ViewData &v, int w, int h);
 gboolean draw_week_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data);
+void update_week_title(WeekViewWidgets *wv);
+// 数据刷新后重绘周页 (页面未创建时什么也不做)
+void week_view_data_changed();
+
+void week_prev(GtkButton *b, gpointer data);
+void week_next(GtkButton *b, gpointer data);
 
 GtkWidget* create_week_page();
 
@@ -0,0 +1,19 @@
+#ifndef YEAR_HPP
+#define YEAR_HPP
+
+#include <gtk/gtk.h>
+#include "types.hpp"
+
+void render_year_view(cairo_t *cr, const Stats &stats, int year, int w, int h);
+gboolean draw_year_view(GtkWidget *widget, GdkEventExpose *event, gpointer data);
+void update_year_title(YearViewWidgets *yv);
+// 数据刷新后重绘年页 (页面未创建时什么也不做)
+void year_view_data_changed();
+
+void year_prev(GtkButton *b, gpointer data);
+void year_next(GtkButton *b, gpointer data);
+gboolean on_year_click(GtkWidget *widget, GdkEventButton *event, gpointer data);
+
+GtkWidget* create_year_page();
+
+#endif
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <gtk/gtk.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+#include "instance.hpp"
+
+static const char *INSTANCE_SOCKET = "/tmp/kykky.sock";
+static const char INSTANCE_REQUEST[] = "activate\n";
+static const char INSTANCE_REPLY[] = "ok\n";
+// 等待已有实例应答的额外轮数 (每轮 2 秒)
+static const int INSTANCE_REPLY_RETRIES = 2;
+
+static int s_listen_fd = -1;
+static InstanceActivateFunc s_on_activate = NULL;
+static int s_signal_pipe[2] = {-1, -1};
+
+static void fill_addr(struct sockaddr_un &addr) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, INSTANCE_SOCKET, sizeof(addr.sun_path) - 1);
+}
+
+static void set_timeout(int fd, int ms) {
+    struct timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+// 读写满 n 字节，被信号打断时重试；超时、出错或对方提前关闭都返回 false
+static bool write_full(int fd, const char *buf, size_t n) {
+    while (n > 0) {
+        ssize_t w = write(fd, buf, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        buf += w;
+        n -= w;
+    }
+    return true;
+}
+
+// timeouts 为允许的读超时次数，每次超时都重新等待；用尽时返回 false
+static bool read_full(int fd, char *buf, size_t n, int timeouts = 0) {
+    while (n > 0) {
+        ssize_t r = read(fd, buf, n);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && timeouts-- > 0) continue;
+        if (r <= 0) return false;
+        buf += r;
+        n -= r;
+    }
+    return true;
+}
+
+InstanceHandoff instance_handoff_to_existing() {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return INSTANCE_NONE;
+
+    struct sockaddr_un addr;
+    fill_addr(addr);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        // 文件不存在，或者存在但没有进程在监听 (上次异常退出留下的)，当前没有运行中的实例
+        if (errno == ECONNREFUSED) unlink(INSTANCE_SOCKET);
+        close(fd);
+        return INSTANCE_NONE;
+    }
+
+    // 连上了就说明对方还活着。它的 UI 线程可能正忙 (解压归档、写快照)，
+    // 请求留在套接字里等它回到主循环，多等几轮；始终没有应答也不能删它的套接字
+    set_timeout(fd, 2000);
+    char reply[sizeof(INSTANCE_REPLY) - 1];
+    bool ok = write_full(fd, INSTANCE_REQUEST, sizeof(INSTANCE_REQUEST) - 1)
+           && read_full(fd, reply, sizeof(reply), INSTANCE_REPLY_RETRIES)
+           && memcmp(reply, INSTANCE_REPLY, sizeof(reply)) == 0;
+    close(fd);
+    return ok ? INSTANCE_ACTIVATED : INSTANCE_BUSY;
+}
+
+static gboolean on_instance_request(GIOChannel *source, GIOCondition cond, gpointer data) {
+    int client = accept(s_listen_fd, NULL, NULL);
+    if (client < 0) return TRUE;
+
+    set_timeout(client, 500);
+    char buf[sizeof(INSTANCE_REQUEST) - 1];
+    bool valid = read_full(client, buf, sizeof(buf))
+              && memcmp(buf, INSTANCE_REQUEST, sizeof(buf)) == 0;
+    // 确认没送到时对方会自己启动，这边就不再激活
+    if (valid) {
+        valid = write_full(client, INSTANCE_REPLY, sizeof(INSTANCE_REPLY) - 1);
+    }
+    close(client);
+
+    if (valid && s_on_activate) s_on_activate();
+    return TRUE;
+}
+
+bool instance_listen(InstanceActivateFunc on_activate) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    struct sockaddr_un addr;
+    fill_addr(addr);
+
+    // 文件已存在：有人在监听就让出，否则是上次异常退出留下的，删掉重建
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 && errno == EADDRINUSE) {
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool alive = probe >= 0 && connect(probe, (struct sockaddr *)&addr, sizeof(addr)) == 0;
+        if (probe >= 0) close(probe);
+        if (alive) {
+            close(fd);
+            return false;
+        }
+        unlink(INSTANCE_SOCKET);
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+            close(fd);
+            return false;
+        }
+    }
+    if (listen(fd, 4) != 0) {
+        close(fd);
+        unlink(INSTANCE_SOCKET);
+        return false;
+    }
+
+    s_listen_fd = fd;
+    s_on_activate = on_activate;
+
+    GIOChannel *ch = g_io_channel_unix_new(fd);
+    g_io_add_watch(ch, G_IO_IN, on_instance_request, NULL);
+    g_io_channel_unref(ch);
+    return true;
+}
+
+// 信号处理函数里只能做异步安全的事：写一个字节，由主循环读到后退出
+static void on_quit_signal(int sig) {
+    int saved = errno;
+    char c = (char)sig;
+    // 管道满时已有未处理的退出请求，丢掉这一个字节即可
+    if (write(s_signal_pipe[1], &c, 1) < 0) {}
+    errno = saved;
+}
+
+static gboolean on_signal_pipe(GIOChannel *source, GIOCondition cond, gpointer data) {
+    char c;
+    if (read(s_signal_pipe[0], &c, 1) != 1) return TRUE;
+    gtk_main_quit();
+    return FALSE;
+}
+
+void instance_install_quit_signals() {
+    if (pipe(s_signal_pipe) != 0) return;
+    fcntl(s_signal_pipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(s_signal_pipe[1], F_SETFD, FD_CLOEXEC);
+    fcntl(s_signal_pipe[1], F_SETFL, O_NONBLOCK);
+
+    GIOChannel *ch = g_io_channel_unix_new(s_signal_pipe[0]);
+    g_io_add_watch(ch, G_IO_IN, on_signal_pipe, NULL);
+    g_io_channel_unref(ch);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_quit_signal;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGTERM, &sa, NULL);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGHUP, &sa, NULL);
+}
+
+void instance_shutdown() {
+    if (s_listen_fd >= 0) {
+        close(s_listen_fd);
+        s_listen_fd = -1;
+        unlink(INSTANCE_SOCKET);
+    }
+}
@@ -0,0 +1,141 @@
+#include <gtk/gtk.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#include "types.hpp"
+#include "dataprocess.hpp"
+#include "loader.hpp"
+
+// 以下状态只在 UI 线程访问，工作线程只写 s_progress
+static LoadProgress s_progress;
+static pthread_t s_thread;
+static bool s_thread_running = false;
+static guint s_progress_timer = 0;
+static LoaderProgressFunc s_on_progress = NULL;
+static LoaderDoneFunc s_on_done = NULL;
+static unsigned int s_run = 0;      // 当前要的一轮，每次开始或重新开始时递增，用于识别过期的结果
+static unsigned int s_thread_run = 0;   // 工作线程正在执行的一轮
+static bool s_restart_pending = false;  // 旧一轮退出后要重新开始
+
+struct LoaderResult {
+    unsigned int run;
+    StatsRef stats;     // 被取消时为空
+};
+
+static void stop_progress_timer() {
+    if (s_progress_timer != 0) {
+        g_source_remove(s_progress_timer);
+        s_progress_timer = 0;
+    }
+}
+
+static void join_worker() {
+    if (s_thread_running) {
+        pthread_join(s_thread, NULL);
+        s_thread_running = false;
+    }
+}
+
+static gboolean loader_progress_tick(gpointer data) {
+    if (s_on_progress) s_on_progress(s_progress);
+    return TRUE;
+}
+
+static bool start_worker();
+
+static gboolean loader_done_idle(gpointer data) {
+    LoaderResult *r = (LoaderResult *)data;
+
+    // 已经被 loader_cancel_and_wait 回收过的线程不再处理
+    if (!s_thread_running || r->run != s_thread_run) {
+        delete r;
+        return FALSE;
+    }
+
+    // 投递结果是工作线程的最后一步，这里的 join 只是回收，不会等待
+    join_worker();
+
+    if (r->run != s_run) {
+        // 被 loader_restart 作废的一轮：结果丢弃，接着开始新一轮
+        if (s_restart_pending) {
+            s_restart_pending = false;
+            if (!start_worker()) stop_progress_timer();
+        }
+    } else {
+        stop_progress_timer();
+        if (r->stats && !s_progress.cancel && s_on_done) {
+            s_on_done(r->stats);
+        }
+    }
+
+    delete r;
+    return FALSE;
+}
+
+static void* loader_thread(void *data) {
+    LoaderResult *r = new LoaderResult();
+    r->run = (unsigned int)(uintptr_t)data;
+
+    // 1. 合并旧日志 / 解压归档 (外部 gzip 命令，无法细分进度)
+    s_progress.preparing = true;
+    preprocess_data();
+    s_progress.preparing = false;
+
+    // 2. 解析日志，构造新版本；取消时返回空
+    if (!s_progress.cancel) {
+        r->stats = build_stats(&s_progress);
+    }
+
+    g_idle_add(loader_done_idle, r);
+    return NULL;
+}
+
+// 以 s_run 开始一轮新的加载
+static bool start_worker() {
+    s_progress.preparing = false;
+    s_progress.bytes_done = 0;
+    s_progress.bytes_total = 0;
+    s_progress.records = 0;
+    s_progress.cancel = false;
+
+    if (pthread_create(&s_thread, NULL, loader_thread, (void *)(uintptr_t)s_run) != 0) return false;
+    s_thread_running = true;
+    s_thread_run = s_run;
+    return true;
+}
+
+bool loader_start(LoaderProgressFunc on_progress, LoaderDoneFunc on_done) {
+    if (s_thread_running) return false;
+
+    s_on_progress = on_progress;
+    s_on_done = on_done;
+
+    s_run++;
+    if (!start_worker()) return false;
+
+    s_progress_timer = g_timeout_add(200, loader_progress_tick, NULL);
+    return true;
+}
+
+void loader_cancel_and_wait() {
+    s_restart_pending = false;
+    s_progress.cancel = true;
+    stop_progress_timer();
+    join_worker();
+}
+
+// 在 UI 线程调用，不等待旧线程：把进行中的一轮标记为过期并请求取消，
+// 等它的结果回到 UI 线程 (loader_done_idle) 时再开始新一轮
+bool loader_restart() {
+    if (!s_on_done) return false;
+    if (!s_thread_running) return loader_start(s_on_progress, s_on_done);
+
+    s_run++;
+    s_progress.cancel = true;
+    s_restart_pending = true;
+    return true;
+}
+
+bool loader_running() {
+    return s_thread_running;
+}
@@ -24,9 +24,13 @@
 #include "daily.hpp"
 #include "week.hpp"
 #include "month.hpp"
+#include "year.hpp"
 #include "overview.hpp"
 #include "network.hpp"
 #include "settingsui.hpp"
+#include "loader.hpp"
+#include "trace.hpp"
+#include "instance.hpp"
 
 // —— 常量定义 ——
 // 基础路径
@@ -40,52 +44,41 @@ const std::string ARCHIVE_FILE = BASE_DIR + "log/history.gz";
 const std::string CONFIG_FILE = BASE_DIR + "etc/config.ini";
 const std::string ETC_TOKEN_FILE = BASE_DIR + "etc/token";
 const std::string STATE_FILE = BASE_DIR + "etc/state";
+const std::string SNAPSHOT_FILE = BASE_DIR + "etc/stats.snapshot";
+// 分享图片保存到 Kindle 的文档目录，可在文档库中查看
+const std::string SHARE_CARD_DIR = "/mnt/us/documents/";
 
 const char *LOG_PREFIX = "metrics_reader_"; 
 const char *TEMP_LOG_FILE = "/tmp/kykky_history.log";
-const std::string PID_FILE = "/tmp/kykky.pid";
 
 // 其他常量
 const int DEFAULT_TARGET_MINUTES = 30;
 const int MIN_TARGET_MINUTES = 10;
 const int MAX_TARGET_MINUTES = 180;
+const int DEFAULT_DETAIL_CACHE_KIB = 256;
 
 const char* APP_TITLE = "L:A_N:application_PC:T_ID:net.tqhyg.reading";
 
 // 全局变量
 int g_daily_target_minutes = DEFAULT_TARGET_MINUTES;
 std::string g_share_domain = "reading.tqhyg.net";
+int g_detail_cache_kib = DEFAULT_DETAIL_CACHE_KIB;
+bool g_gray_render = false;
 
 GdkColor white = {0, 0xffff, 0xffff, 0xffff};
 GdkColor gray = {0, 0x8888, 0x8888, 0x8888};
 
-Stats g_stats;
+ViewData g_view_data;
 int g_view_year;
 int g_view_month;
 time_t g_view_daily_ts;
+time_t g_view_week_start;
+int g_view_heatmap_year;
 
 UIHandles g_ui_handles = {NULL, NULL};
 GtkWidget *g_notebook = NULL;      // 全局笔记本控件指针
 DailyViewWidgets *g_daily_widgets = NULL; // 全局日视图组件指针
 
-pid_t get_existing_pid() {
-    FILE *f = fopen(PID_FILE.c_str(), "r");
-    if (!f) return 0;
-    pid_t pid = 0;
-    if (fscanf(f, "%d", &pid) != 1) pid = 0;
-    fclose(f);
-    return pid;
-}
-
-bool check_and_raise_existing_instance() {
-    pid_t pid = get_existing_pid();
-    if (pid > 0) {
-        kill(pid, SIGTERM);
-        return true;
-    }
-    return false;
-}
-
 // —— 退出页 ——
 static GtkWidget* create_exit_page() {
     // 创建一个标签，背景设为白色
@@ -100,6 +93,44 @@ static GtkWidget* create_exit_page() {
     return label;
 }
 
+// —— 页面延迟构建 ——
+// 启动时只构建概览页，其余 Tab 先放一个空白容器，
+// 第一次切换到该页时才创建控件树；空闲时顺便预建下一个 Tab
+typedef GtkWidget* (*PageFactory)();
+
+struct LazyPage {
+    GtkWidget *holder;      // 占位容器，页面建好后放入其中
+    PageFactory factory;    // NULL 表示已构建 (或无需构建)
+};
+
+static std::vector<LazyPage> s_lazy_pages;
+static guint s_prebuild_source = 0;
+
+static void ensure_page_built(guint page_num) {
+    if (page_num >= s_lazy_pages.size()) return;
+    LazyPage &lp = s_lazy_pages[page_num];
+    if (!lp.factory) return;
+
+    TRACE_SCOPE("build_page");
+    GtkWidget *page = lp.factory();
+    lp.factory = NULL;
+    gtk_container_add(GTK_CONTAINER(lp.holder), page);
+    gtk_widget_show_all(page);
+}
+
+static gboolean prebuild_page_idle(gpointer data) {
+    s_prebuild_source = 0;
+    ensure_page_built(GPOINTER_TO_UINT(data));
+    return FALSE;
+}
+
+static void schedule_page_prebuild(guint page_num) {
+    if (s_prebuild_source != 0) {
+        g_source_remove(s_prebuild_source);
+    }
+    s_prebuild_source = g_idle_add(prebuild_page_idle, GUINT_TO_POINTER(page_num));
+}
+
 static void on_notebook_switch_page(GtkNotebook *notebook, 
                                     GtkWidget *page, 
                                     guint page_num, 
@@ -107,13 +138,19 @@ static void on_notebook_switch_page(GtkNotebook *notebook,
     guint n_pages = gtk_notebook_get_n_pages(notebook);
     if (page_num == n_pages - 1) {
         gtk_main_quit();
+        return;
+    }
+
+    ensure_page_built(page_num);
+    // 用户多半会继续往右翻，空闲时预建下一页 (退出页除外)
+    if (page_num + 1 < n_pages - 1) {
+        schedule_page_prebuild(page_num + 1);
     }
 }
 
 // 启动时后台静默同步
 struct StartupSyncData {
-    long today_seconds;
-    long month_seconds;
+    StatsRef stats; // 启动时的 Stats 版本，线程内只读
 };
 
 static gboolean startup_sync_idle(gpointer data) {
@@ -127,7 +164,7 @@ static gpointer startup_sync_thread(gpointer data) {
     StartupSyncData *sd = (StartupSyncData *)data;
     KykkyNetwork &net = KykkyNetwork::instance();
     if (net.check_internet()) {
-        net.upload_data(sd->today_seconds, sd->month_seconds);
+        net.upload_data(sd->stats->today_seconds, sd->stats->month_seconds);
     }
     g_idle_add(startup_sync_idle, sd);
     return NULL;
@@ -142,68 +179,62 @@ static void spawn_detached_thread(void*(*func)(void*), void *data) {
     pthread_attr_destroy(&attr);
 }
 
-// —— 主函数 —— 
-int main(int argc, char *argv[]) {
-    // 0. 单例检查
-    
-    if (check_and_raise_existing_instance()) {
-        printf("Application is already running. Killing existing process.\n");
-    }
-
-    FILE *f = fopen(PID_FILE.c_str(), "w");
-    if (f) {
-        fprintf(f, "%d", getpid());
-        fclose(f);
-    }
-
-    gtk_init(&argc, &argv);
-
-    // 1. 初始化窗口和主容器
-    GtkWidget *win = gtk_window_new(GTK_WINDOW_TOPLEVEL);
-    gtk_window_set_title(GTK_WINDOW(win), APP_TITLE);
-    gtk_window_set_default_size(GTK_WINDOW(win), 1072, 1200);
-
-    g_signal_connect(G_OBJECT(win), "destroy", G_CALLBACK(gtk_main_quit), NULL);
-
-    gtk_widget_modify_bg(win, GTK_STATE_NORMAL, &white);
-
-    GtkWidget *vbox = gtk_vbox_new(FALSE, 0);
-    gtk_container_add(GTK_CONTAINER(win), vbox);
+// —— 启动时的日志读取 ——
+// 界面先用快照数据绘制，预处理和增量解析在后台线程进行，完成后原地刷新各页
+static void on_loader_progress(const LoadProgress &progress) {
+    update_overview_progress(progress);
+}
 
-    gtk_widget_modify_bg(vbox, GTK_STATE_NORMAL, &white);
+static void on_loader_done(StatsRef stats) {
+    stats_publish(stats);
+    refresh_view_data(g_view_data, g_view_year, g_view_month);
+    daily_view_load_pending();
 
-    // 2. 创建等待界面 (居中的 Label)
-    GtkWidget *align = gtk_alignment_new(0.5, 0.5, 0, 0);
-    GtkWidget *wait_label = gtk_label_new("正在处理数据...");
-    PangoFontDescription *wait_font = pango_font_description_from_string("Sans 22");
-    gtk_widget_modify_font(wait_label, wait_font);
-    pango_font_description_free(wait_font);
+    update_overview_page();
+    if (g_daily_widgets) {
+        update_daily_view_ui(g_daily_widgets);
+    }
+    // 各页只重绘数据有变化的部分，不整页刷新 notebook，减少墨水屏闪烁
+    week_view_data_changed();
+    month_view_data_changed();
+    year_view_data_changed();
 
-    gtk_container_add(GTK_CONTAINER(align), wait_label);
-    gtk_box_pack_start(GTK_BOX(vbox), align, TRUE, TRUE, 0);
+    // 日志读完后预建 "时段详情"，这是概览之后最常打开的页
+    schedule_page_prebuild(1);
 
-    gtk_widget_show_all(win);
+    trace_startup_done();
 
-    // 强制 UI 渲染等待界面
-    while (gtk_events_pending()) gtk_main_iteration();
-    usleep(800000); //让用户觉得程序在干活
+    // 启动后台同步线程（不阻塞 UI），上传的是解析完成后的数据
+    if (KykkyNetwork::instance().get_user_info().is_logged_in) {
+        StartupSyncData *ssd = new StartupSyncData();
+        ssd->stats = stats_current();
+        spawn_detached_thread(startup_sync_thread, ssd);
+    }
+}
 
-    // 3. 执行耗时的预处理和数据收集
-    preprocess_data();
+static gboolean on_first_expose(GtkWidget *win, GdkEventExpose *event, gpointer data) {
+    // 只在第一次绘制后触发
+    g_signal_handlers_disconnect_by_func(G_OBJECT(win), (gpointer)on_first_expose, data);
+    trace_instant("first_expose");
+    loader_start(on_loader_progress, on_loader_done);
+    return FALSE;
+}
 
-    load_target_config(); 
-    KykkyNetwork::instance().init();
+// 再次启动时由新进程转交过来：显示窗口并增量刷新 (快照 + 新增日志)
+static GtkWidget *s_main_window = NULL;
 
-    time_t now = time(NULL);
-    struct tm tmv;
-    localtime_r(&now, &tmv);
-    g_view_year = tmv.tm_year + 1900;
-    g_view_month = tmv.tm_mon + 1;
-
-    read_logs_and_compute_stats(g_stats, g_view_year, g_view_month, true);
+static void on_instance_activate() {
+    if (s_main_window) {
+        gtk_window_present(GTK_WINDOW(s_main_window));
+    }
+    if (!loader_running()) {
+        loader_start(on_loader_progress, on_loader_done);
+    }
+}
 
-    // 5. 销毁等待界面并切换到正式内容
-    gtk_widget_destroy(align); 
+// —— 主界面 Tab ——
+static void create_notebook(GtkWidget *vbox) {
+    TRACE_SCOPE("build_pages");
 
     GtkWidget *nb = gtk_notebook_new();
     g_notebook = nb;
@@ -223,33 +254,117 @@ int main(int argc, char *argv[]) {
         }
 
         gtk_notebook_append_page(GTK_NOTEBOOK(nb), page, tab);
+        LazyPage lp = {page, NULL};
+        s_lazy_pages.push_back(lp);
+    };
+
+    // 延迟构建的页面先放入白底占位容器
+    auto add_lazy_tab = [&](PageFactory factory, const char *name) {
+        GtkWidget *holder = gtk_event_box_new();
+        gtk_widget_modify_bg(holder, GTK_STATE_NORMAL, &white);
+        add_tab(holder, name);
+        s_lazy_pages.back().factory = factory;
     };
 
     add_tab(create_overview_page(), "概览");
-    add_tab(create_today_page(), "时段详情");
-    add_tab(create_week_page(), "周分布");
-    add_tab(create_month_page(), "阅读日历");
-    add_tab(create_settings_page(), "更多");
+    add_lazy_tab(create_today_page, "时段详情");
+    add_lazy_tab(create_week_page, "周分布");
+    add_lazy_tab(create_month_page, "阅读日历");
+    add_lazy_tab(create_year_page, "年度");
+    add_lazy_tab(create_settings_page, "更多");
     add_tab(create_exit_page(), " X ");
 
     pango_font_description_free(tab_font);
 
     g_signal_connect(G_OBJECT(nb), "switch-page", G_CALLBACK(on_notebook_switch_page), NULL);
+}
 
-    gtk_widget_show_all(win);
+// —— 主函数 —— 
+int main(int argc, char *argv[]) {
+    trace_init();
 
-    // 启动后台同步线程（不阻塞 UI）
-    if (KykkyNetwork::instance().get_user_info().is_logged_in) {
-        StartupSyncData *ssd = new StartupSyncData();
-        ssd->today_seconds = g_stats.today_seconds;
-        ssd->month_seconds = g_stats.month_seconds;
-        spawn_detached_thread(startup_sync_thread, ssd);
+    // 0. 单例检查：已有实例时把请求交给它，自己直接退出
+    InstanceHandoff handoff = instance_handoff_to_existing();
+    if (handoff == INSTANCE_ACTIVATED) {
+        printf("Application is already running. Activated existing instance.\n");
+        return 0;
+    }
+    if (handoff == INSTANCE_BUSY) {
+        printf("Application is already running but busy; it will come to front when ready.\n");
+        return 0;
     }
 
+    {
+        TRACE_SCOPE("gtk_init");
+        gtk_init(&argc, &argv);
+    }
+
+    // 两个进程同时启动时，抢不到套接字的一方同样转交后退出
+    if (!instance_listen(on_instance_activate) && instance_handoff_to_existing() != INSTANCE_NONE) {
+        return 0;
+    }
+    instance_install_quit_signals();
+
+    // 1. 初始化窗口和主容器
+    GtkWidget *win = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+    s_main_window = win;
+    gtk_window_set_title(GTK_WINDOW(win), APP_TITLE);
+    gtk_window_set_default_size(GTK_WINDOW(win), 1072, 1200);
+
+    g_signal_connect(G_OBJECT(win), "destroy", G_CALLBACK(gtk_main_quit), NULL);
+
+    gtk_widget_modify_bg(win, GTK_STATE_NORMAL, &white);
+
+    GtkWidget *vbox = gtk_vbox_new(FALSE, 0);
+    gtk_container_add(GTK_CONTAINER(win), vbox);
+
+    gtk_widget_modify_bg(vbox, GTK_STATE_NORMAL, &white);
+
+    // 2. 读取配置，初始化各视图的日期
+    {
+        TRACE_SCOPE("load_config");
+        load_target_config(); 
+    }
+    {
+        TRACE_SCOPE("network_init");
+        KykkyNetwork::instance().init();
+    }
+
+#ifdef KYKKY_DEBUG
+    // 调试版本退出时打印内存占用
+    atexit(print_memory_report);
+#endif
+
+    time_t now = time(NULL);
+    struct tm tmv;
+    localtime_r(&now, &tmv);
+    g_view_year = tmv.tm_year + 1900;
+    g_view_month = tmv.tm_mon + 1;
+    g_view_daily_ts = get_day_start(now);
+    get_week_start(g_view_week_start);
+    g_view_heatmap_year = g_view_year;
+
+    // 3. 先用上次保存的快照生成界面 (标记为临时数据)，
+    //    解压归档、解析新日志等耗时操作放到首帧绘制之后
+    publish_cached_stats();
+    refresh_view_data(g_view_data, g_view_year, g_view_month);
+    daily_view_load_pending();
+
+    create_notebook(vbox);
+
+    // 4. 首帧绘制完成后再读取日志
+    g_signal_connect_after(G_OBJECT(win), "expose-event", G_CALLBACK(on_first_expose), NULL);
+
+    gtk_widget_show_all(win);
+
     gtk_main();
 
+    // 加载线程可能还在读 TEMP_LOG_FILE，先让它停下
+    loader_cancel_and_wait();
+    trace_flush();
+
     // --- 清理临时文件 ---
     unlink(TEMP_LOG_FILE);
-    unlink(PID_FILE.c_str());
+    instance_shutdown();
     return 0;
 }
@@ -1,10 +1,16 @@
 #include <string.h>
+#include <algorithm>
+#include <map>
+#include <vector>
 
 #include "types.hpp"
 #include "utils.hpp"
 #include "daily.hpp"
 #include "dataprocess.hpp"
 #include "month.hpp"
+#include "render.hpp"
+#include "prefetch.hpp"
+#include "navsched.hpp"
 
 // 将比例值（0.0-1.0）映射到16阶灰度值（0.0-1.0）
 // ratio=0.0 → 灰度=1.0（白色）
@@ -23,41 +29,31 @@ double get_gray_level_16(double ratio) {
     return 1.0 - (level / 15.0);
 }
 
-gboolean draw_month_view(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
-    cairo_t *cr = gdk_cairo_create(gtk_widget_get_window(widget));
-
-    cairo_set_source_rgb(cr, 1, 1, 1);
-    cairo_paint(cr);
-
-    int w = widget->allocation.width;
-    int h = widget->allocation.height;
-
+// —— 月历布局与格子状态 ——
+// 布局只与画布尺寸和月份有关；格子状态 (日期、灰度、显示的分钟数) 决定格子的样子，
+// 刷新时对比新旧状态，只重绘变化的格子
+struct MonthLayout {
+    double left;
+    double top;
+    double cw;          // 单元格宽
+    double ch;          // 单元格高
+    int first_col;      // 1 号所在列 (0=Mon)
+};
+
+struct MonthCellState {
+    int day;            // 0 表示该格不属于本月
+    double gray;
+    long minutes;
+};
+
+static const int MONTH_CELLS = 42;  // 6 行 × 7 列日期格
+
+static void compute_month_layout(int w, int h, int year, int month, MonthLayout &lay) {
     int left = 20, top = 10, right = 20, bottom = 10;
-
-    int grid_w = w - left - right;
-    int grid_h = h - top - bottom;
-
-    int rows = 7, cols = 7;
-    double cw = grid_w / (double)cols;
-    double ch = grid_h / (double)rows;
-
-    const char *weeknames[7] = {"Mon","Tue","Wed","Thu","Fri","Sat","Sun"};
-    cairo_set_source_rgb(cr, 1, 1, 1); 
-    cairo_rectangle(cr, left, top, grid_w, ch);
-    cairo_fill(cr);
-
-    cairo_set_source_rgb(cr, 0, 0, 0); 
-    cairo_set_font_size(cr, 40);
-    for (int i = 0; i < 7; i++) {
-        double x = left + i * cw + cw/2 - 40; 
-        double y = top + ch/2 + 15; 
-        cairo_move_to(cr, x, y);
-        cairo_show_text(cr, weeknames[i]);
-    }
-
-    int year = g_stats.month_year;
-    int month = g_stats.month_month;
-    int days = g_stats.month_day_seconds.size();
+    lay.left = left;
+    lay.top = top;
+    lay.cw = (w - left - right) / 7.0;
+    lay.ch = (h - top - bottom) / 7.0;   // 1 行标题 + 6 行日期
 
     struct tm tmv;
     memset(&tmv, 0, sizeof(tmv));
@@ -66,128 +62,338 @@ gboolean draw_month_view(GtkWidget *widget, GdkEventExpose *event, gpointer data
     tmv.tm_mday = 1;
     time_t t0 = mktime(&tmv);
     localtime_r(&t0, &tmv);
+    lay.first_col = (tmv.tm_wday == 0 ? 6 : tmv.tm_wday - 1);
+}
 
-    int wday = tmv.tm_wday;
-    int first_col = (wday == 0 ? 6 : wday - 1);
+// target_minutes 随视图数据传入：分享图片在后台线程绘制，不能读全局设置
+static void compute_month_cells(const MonthLayout &lay, const std::vector<long> &secs, int target_minutes,
+                                MonthCellState cells[MONTH_CELLS]) {
+    int days = secs.size();
 
     // 找出本月阅读时间最长的一天作为基准
-    long basic_sec = g_daily_target_minutes * 60; // 最小基准值
-    long max_seconds = g_daily_target_minutes * 60; //默认最长值
+    long basic_sec = target_minutes * 60L; // 最小基准值
+    long max_seconds = target_minutes * 60L; //默认最长值
     for (int i = 0; i < days; i++) {
-        if (g_stats.month_day_seconds[i] > max_seconds) {
-            max_seconds = g_stats.month_day_seconds[i];
-        }
+        if (secs[i] > max_seconds) max_seconds = secs[i];
     }
 
-    for (int d = 1; d <= days; d++) {
-        int idx = d - 1;
-        int off = first_col + idx;
-        int r = off / cols + 1;
-        int c = off % cols;
+    for (int i = 0; i < MONTH_CELLS; i++) {
+        cells[i].day = 0;
+        cells[i].gray = 1.0;
+        cells[i].minutes = 0;
+    }
 
-        double x = left + c * cw;
-        double y = top + r * ch;
+    for (int d = 1; d <= days; d++) {
+        MonthCellState &c = cells[lay.first_col + d - 1];
+        long sec = secs[d - 1];
 
-        long sec = g_stats.month_day_seconds[idx];
-        
-        // 计算该天相对于最大值的比例
+        // 计算该天相对于最大值的比例，映射到16阶灰度值（0.0=黑，1.0=白）
         double ratio = 0.0;
-        if ( (double)sec > (double)basic_sec ) {
+        if ((double)sec > (double)basic_sec) {
             ratio = (double)sec / (double)max_seconds;
         }
-        
-        // 获取对应的16阶灰度值（0.0=黑，1.0=白）
-        double gray = get_gray_level_16(ratio);
-        
-        // 设置背景色（灰度值）
-        cairo_set_source_rgb(cr, gray, gray, gray);
-        cairo_rectangle(cr, x, y, cw, ch);
-        cairo_fill(cr);
-        
-        // 根据背景灰度决定文字颜色
-        // 灰度 < 0.5（较暗）用白字，>= 0.5（较亮）用黑字
-        if (gray < 0.5) {
-            cairo_set_source_rgb(cr, 1, 1, 1); // 白字
-        } else {
-            cairo_set_source_rgb(cr, 0, 0, 0); // 黑字
-        }
-        
-        // 绘制边框（黑色）
-        cairo_set_source_rgb(cr, 0, 0, 0);
-        cairo_rectangle(cr, x, y, cw, ch);
-        cairo_stroke(cr);
-        
-        // 恢复文字颜色
-        if (gray < 0.5) {
-            cairo_set_source_rgb(cr, 1, 1, 1);
+        c.day = d;
+        c.gray = get_gray_level_16(ratio);
+        c.minutes = sec / 60;
+    }
+}
+
+static bool same_cell(const MonthCellState &a, const MonthCellState &b) {
+    return a.day == b.day && a.gray == b.gray && a.minutes == b.minutes;
+}
+
+static long month_total_seconds(const std::vector<long> &secs) {
+    long total = 0;
+    for (size_t i = 0; i < secs.size(); i++) {
+        total += secs[i];
+    }
+    return total;
+}
+
+// 最近一次贴到屏幕上的内容，用于计算刷新区域
+static MonthCellState s_drawn_cells[MONTH_CELLS];
+static long s_drawn_total = -1;
+static int s_drawn_w = 0, s_drawn_h = 0;
+
+void render_month_view(cairo_t *cr, const ViewData &v, int w, int h) {
+    set_gray(cr, 1);
+    cairo_paint(cr);
+
+    MonthLayout lay;
+    compute_month_layout(w, h, v.month_year, v.month_month, lay);
+
+    const char *weeknames[7] = {"Mon","Tue","Wed","Thu","Fri","Sat","Sun"};
+    set_gray(cr, 0);
+    cairo_set_font_size(cr, 40);
+    for (int i = 0; i < 7; i++) {
+        double x = lay.left + i * lay.cw + lay.cw/2 - 40; 
+        double y = lay.top + lay.ch/2 + 15; 
+        cairo_move_to(cr, x, y);
+        cairo_show_text(cr, weeknames[i]);
+    }
+
+    MonthCellState cells[MONTH_CELLS];
+    compute_month_cells(lay, v.month_day_seconds, v.month_target_minutes, cells);
+
+    // 分三遍绘制，减少光栅化次数：
+    // 1. 同一灰度的格子合成一次填充
+    std::vector<GrayRect> fills;
+    fills.reserve(MONTH_CELLS);
+    for (int i = 0; i < MONTH_CELLS; i++) {
+        if (cells[i].day == 0) continue;
+        GrayRect r;
+        r.gray = cells[i].gray;
+        r.x = lay.left + (i % 7) * lay.cw;
+        r.y = lay.top + (i / 7 + 1) * lay.ch;
+        r.w = lay.cw;
+        r.h = lay.ch;
+        fills.push_back(r);
+    }
+    fill_rects_by_gray(cr, fills);
+
+    // 2. 所有边框一次描边（黑色）
+    set_gray(cr, 0);
+    for (size_t i = 0; i < fills.size(); i++) {
+        cairo_rectangle(cr, fills[i].x, fills[i].y, fills[i].w, fills[i].h);
+    }
+    cairo_stroke(cr);
+
+    // 3. 文字按颜色分两遍：灰度 < 0.5（较暗）用白字，>= 0.5（较亮）用黑字
+    for (int pass = 0; pass < 2; pass++) {
+        bool dark = (pass == 0);
+        if (dark) {
+            set_gray(cr, 1);
         } else {
-            cairo_set_source_rgb(cr, 0, 0, 0);
+            set_gray(cr, 0);
         }
 
-        char buf[32];
-        snprintf(buf, sizeof(buf), "%d", d);
-        cairo_set_font_size(cr, 40);
-        cairo_move_to(cr, x + 10, y + 50);
-        cairo_show_text(cr, buf);
+        for (int i = 0; i < MONTH_CELLS; i++) {
+            const MonthCellState &c = cells[i];
+            if (c.day == 0 || (c.gray < 0.5) != dark) continue;
 
-        snprintf(buf, sizeof(buf), "%ldH:%02ldm", sec/3600, sec/60%60);
-        cairo_set_font_size(cr, 32);
-        cairo_move_to(cr, x + 10, y + 90);
-        cairo_show_text(cr, buf);
+            double x = lay.left + (i % 7) * lay.cw;
+            double y = lay.top + (i / 7 + 1) * lay.ch;
+
+            char buf[32];
+            snprintf(buf, sizeof(buf), "%d", c.day);
+            cairo_set_font_size(cr, 40);
+            cairo_move_to(cr, x + 10, y + 50);
+            cairo_show_text(cr, buf);
+
+            snprintf(buf, sizeof(buf), "%ldH:%02ldm", c.minutes/60, c.minutes%60);
+            cairo_set_font_size(cr, 32);
+            cairo_move_to(cr, x + 10, y + 90);
+            cairo_show_text(cr, buf);
+        }
     }
 
     char month_total_str[64];
-    long month_total_seconds = 0;
-    for (size_t i = 0; i < g_stats.month_day_seconds.size(); i++) {
-        month_total_seconds += g_stats.month_day_seconds[i];
-    }
-    format_hms(month_total_seconds, month_total_str, sizeof(month_total_str));
+    format_hms(month_total_seconds(v.month_day_seconds), month_total_str, sizeof(month_total_str));
 
     char month_title[128];
     snprintf(month_title, sizeof(month_title), "本月总时长: %s", month_total_str);
 
-    cairo_set_source_rgb(cr, 0, 0, 0);
+    set_gray(cr, 0);
     cairo_set_font_size(cr, 50);
-    cairo_move_to(cr, left + 360, h - 40); 
+    cairo_move_to(cr, lay.left + 360, h - 40); 
     cairo_show_text(cr, month_title);
+}
+
+static ChartCache s_month_chart;
+
+// 记录当前视图数据对应的格子，作为屏幕上的内容
+static void remember_drawn_month(int w, int h) {
+    MonthLayout lay;
+    compute_month_layout(w, h, g_view_data.month_year, g_view_data.month_month, lay);
+    compute_month_cells(lay, g_view_data.month_day_seconds, g_view_data.month_target_minutes, s_drawn_cells);
+    s_drawn_total = month_total_seconds(g_view_data.month_day_seconds);
+    s_drawn_w = w;
+    s_drawn_h = h;
+}
+
+static void schedule_month_prefetch();
+
+gboolean draw_month_view(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
+    chart_cache_paint(s_month_chart, widget, event, g_view_data.month_version, render_month_view);
 
-    cairo_destroy(cr);
+    // 首次显示后才能按画布尺寸预渲染相邻月份
+    bool first = (s_drawn_total < 0);
+    remember_drawn_month(widget->allocation.width, widget->allocation.height);
+    if (first) schedule_month_prefetch();
     return FALSE;
 }
 
+// 月历数据变化后调用：与上次绘制的格子逐个比较，只让变化的格子失效，
+// 墨水屏只刷新这些区域，而不是整块画布
+static void invalidate_month_changes(GtkWidget *da) {
+    GdkWindow *win = gtk_widget_get_window(da);
+    if (!win) return;
+
+    int w = da->allocation.width;
+    int h = da->allocation.height;
+    if (s_drawn_total < 0 || w != s_drawn_w || h != s_drawn_h) {
+        gtk_widget_queue_draw(da);
+        return;
+    }
+
+    MonthLayout lay;
+    compute_month_layout(w, h, g_view_data.month_year, g_view_data.month_month, lay);
+    MonthCellState cells[MONTH_CELLS];
+    compute_month_cells(lay, g_view_data.month_day_seconds, g_view_data.month_target_minutes, cells);
+
+    for (int i = 0; i < MONTH_CELLS; i++) {
+        if (same_cell(cells[i], s_drawn_cells[i])) continue;
+        // 多留 1 像素给边框线
+        GdkRectangle r;
+        r.x = (int)(lay.left + (i % 7) * lay.cw) - 1;
+        r.y = (int)(lay.top + (i / 7 + 1) * lay.ch) - 1;
+        r.width = (int)lay.cw + 3;
+        r.height = (int)lay.ch + 3;
+        gdk_window_invalidate_rect(win, &r, FALSE);
+    }
+
+    // 底部的月总时长压在最后一行格子上，变化时重绘整条
+    if (month_total_seconds(g_view_data.month_day_seconds) != s_drawn_total) {
+        GdkRectangle r;
+        r.x = 0;
+        r.y = h - 95;
+        r.width = w;
+        r.height = 95;
+        gdk_window_invalidate_rect(win, &r, FALSE);
+    }
+}
+
+static MonthViewWidgets *s_month_widgets = NULL;
+
+void month_view_data_changed() {
+    if (!s_month_widgets) return;
+    invalidate_month_changes(s_month_widgets->drawing_area);
+    // 数据或目标变化后，已预取的相邻月份按版本判定失效，重新预取
+    schedule_month_prefetch();
+}
+
 void update_month_title(MonthViewWidgets *mv) {
     char buf[64];
     snprintf(buf, sizeof(buf), "%04d年%02d月", g_view_year, g_view_month);
     gtk_label_set_text(GTK_LABEL(mv->label_title), buf);
 }
 
-void month_prev(GtkButton *b, gpointer data) {
-    MonthViewWidgets *mv = (MonthViewWidgets*)data;
-    g_view_month--;
-    if (g_view_month < 1) {
-        g_view_month = 12;
-        g_view_year--;
+// —— 相邻月份预取 ——
+// 翻月后在空闲时算好前后两个月的数据并画好图表，再翻过去时只需换图
+struct MonthPrefetch {
+    std::vector<long> days;
+    unsigned int generation;    // 数据所属的 Stats 版本
+    int target_minutes;         // 灰度基准依赖每日目标
+    ChartCache image;
+};
+
+static std::map<int, MonthPrefetch> s_month_prefetch;   // 键: 年 * 100 + 月
+
+static int month_key(int year, int month) {
+    return year * 100 + month;
+}
+
+static void shift_month(int &year, int &month, int delta) {
+    month += delta;
+    while (month < 1) { month += 12; year--; }
+    while (month > 12) { month -= 12; year++; }
+}
+
+static void drop_month_prefetch(std::map<int, MonthPrefetch>::iterator it) {
+    chart_cache_reset(it->second.image);
+    s_month_prefetch.erase(it);
+}
+
+static void prefetch_month(int year, int month) {
+    if (!s_month_widgets) return;
+    StatsRef stats = stats_current();
+
+    auto it = s_month_prefetch.find(month_key(year, month));
+    if (it != s_month_prefetch.end()) {
+        if (it->second.generation == stats->generation
+            && it->second.target_minutes == g_daily_target_minutes) return;
+        drop_month_prefetch(it);
     }
-    // [优化] 只查 Map
-    read_logs_and_compute_stats(g_stats, g_view_year, g_view_month, false);
-    update_month_title(mv);
-    gtk_widget_queue_draw(mv->drawing_area);
+
+    ViewData v = ViewData();
+    v.month_year = year;
+    v.month_month = month;
+    v.month_target_minutes = g_daily_target_minutes;
+    compute_month_days(*stats, year, month, v.month_day_seconds);
+
+    MonthPrefetch pf;
+    pf.generation = stats->generation;
+    pf.target_minutes = g_daily_target_minutes;
+    pf.image = ChartCache();
+    if (!chart_cache_prerender(pf.image, s_month_widgets->drawing_area, v, render_month_view)) return;
+    pf.days.swap(v.month_day_seconds);
+    s_month_prefetch[month_key(year, month)] = pf;
 }
 
-void month_next(GtkButton *b, gpointer data) {
-    MonthViewWidgets *mv = (MonthViewWidgets*)data;
-    g_view_month++;
-    if (g_view_month > 12) {
-        g_view_month = 1;
-        g_view_year++;
+static void schedule_month_prefetch() {
+    prefetch_cancel(PREFETCH_MONTH);
+
+    int py = g_view_year, pm = g_view_month;
+    int ny = g_view_year, nm = g_view_month;
+    shift_month(py, pm, -1);
+    shift_month(ny, nm, 1);
+
+    // 只保留当前月前后各一个月
+    int keep_lo = month_key(py, pm), keep_hi = month_key(ny, nm);
+    for (auto it = s_month_prefetch.begin(); it != s_month_prefetch.end(); ) {
+        auto cur = it++;
+        if (cur->first != keep_lo && cur->first != keep_hi) drop_month_prefetch(cur);
     }
-    read_logs_and_compute_stats(g_stats, g_view_year, g_view_month, false);
+
+    prefetch_add(PREFETCH_MONTH, [py, pm]() { prefetch_month(py, pm); });
+    prefetch_add(PREFETCH_MONTH, [ny, nm]() { prefetch_month(ny, nm); });
+}
+
+// 切换到 g_view_year/g_view_month：有可用的预取结果时直接换入数据和图表
+static void apply_view_month(MonthViewWidgets *mv) {
+    StatsRef stats = stats_current();
+    auto it = s_month_prefetch.find(month_key(g_view_year, g_view_month));
+    if (it != s_month_prefetch.end() && it->second.generation == stats->generation
+        && it->second.target_minutes == g_daily_target_minutes) {
+        set_month_view_data(g_view_data, g_view_year, g_view_month, it->second.days,
+                            it->second.target_minutes);
+        chart_cache_adopt(s_month_chart, it->second.image, mv->drawing_area, g_view_data.month_version);
+        s_month_prefetch.erase(it);
+    } else {
+        // 只查 Map，不重读日志
+        refresh_month_view_data(g_view_data, *stats, g_view_year, g_view_month);
+    }
+}
+
+static NavScheduler s_month_nav;
+
+static void commit_month_step(gpointer data) {
+    MonthViewWidgets *mv = (MonthViewWidgets*)data;
+    apply_view_month(mv);
+    invalidate_month_changes(mv->drawing_area);
+    schedule_month_prefetch();
+}
+
+static void month_step(MonthViewWidgets *mv, int delta) {
+    // 标题立即更新，数据和重绘等点击停下后只做一次
+    shift_month(g_view_year, g_view_month, delta);
     update_month_title(mv);
-    gtk_widget_queue_draw(mv->drawing_area);
+    prefetch_cancel(PREFETCH_MONTH);
+    nav_request(s_month_nav, commit_month_step, mv);
+}
+
+void month_prev(GtkButton *b, gpointer data) {
+    month_step((MonthViewWidgets*)data, -1);
+}
+
+void month_next(GtkButton *b, gpointer data) {
+    month_step((MonthViewWidgets*)data, 1);
 }
 
 gboolean on_month_click(GtkWidget *widget, GdkEventButton *event, gpointer data) {
     if (event->type != GDK_BUTTON_PRESS) return FALSE;
+    // 翻月尚未重绘时，屏幕上的格子与当前月份对不上
+    if (s_month_nav.source) return FALSE;
 
     // 1. 获取和绘图函数完全一致的布局参数
     int w = widget->allocation.width;
@@ -245,30 +451,10 @@ gboolean on_month_click(GtkWidget *widget, GdkEventButton *event, gpointer data)
     int days_in_this_month = days_in_month(g_view_year, g_view_month);
 
     if (day > 0 && day <= days_in_this_month) {
-        // --- 下面是跳转逻辑，保持你原来的不变 ---
-        
-        // A. 构造目标日期
+        // 构造目标日期并跳转到日视图
         struct tm target_tm = tm_first;
         target_tm.tm_mday = day;
-        time_t target_ts = mktime(&target_tm);
-        
-        // B. 更新全局日期
-        g_view_daily_ts = target_ts;
-
-        // C. 刷新数据
-        refresh_daily_view_data(g_stats, g_view_daily_ts);
-        
-        // D. 更新日视图 UI
-        if (g_daily_widgets) {
-            update_daily_view_ui(g_daily_widgets);
-            gtk_widget_queue_draw(g_daily_widgets->drawing_area);
-        }
-
-        // E. 切换 Tab
-        if (g_notebook) {
-            // 请确认 "今日分布" 确实是第 2 个 tab (索引 1)
-            gtk_notebook_set_current_page(GTK_NOTEBOOK(g_notebook), 1);
-        }
+        show_daily_view(mktime(&target_tm));
     }
 
     return TRUE;
@@ -278,6 +464,7 @@ GtkWidget* create_month_page() {
     GtkWidget *vbox = gtk_vbox_new(FALSE, 5);
 
     MonthViewWidgets *mv = (MonthViewWidgets*)g_malloc0(sizeof(MonthViewWidgets));
+    s_month_widgets = mv;
 
     GtkWidget *hbox = gtk_hbox_new(FALSE, 5);
     GtkWidget *btn_prev = gtk_button_new_with_label("<-上个月");
@@ -0,0 +1,26 @@
+#include <gtk/gtk.h>
+
+#include "navsched.hpp"
+
+// 点击停止多久后才提交
+static const guint NAV_DEBOUNCE_MS = 250;
+
+static gboolean nav_timeout(gpointer user_data) {
+    NavScheduler *ns = (NavScheduler *)user_data;
+    ns->source = 0;
+    ns->commit(ns->data);
+    return FALSE;
+}
+
+void nav_request(NavScheduler &ns, NavCommitFunc commit, gpointer data) {
+    if (ns.source) g_source_remove(ns.source);
+    ns.commit = commit;
+    ns.data = data;
+    ns.source = g_timeout_add(NAV_DEBOUNCE_MS, nav_timeout, &ns);
+}
+
+void nav_cancel(NavScheduler &ns) {
+    if (!ns.source) return;
+    g_source_remove(ns.source);
+    ns.source = 0;
+}
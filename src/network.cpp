@@ -11,6 +11,7 @@
 #include <dirent.h>
 #include <cstring>
 #include <cstdint>
+#include <pthread.h>
 
 #define MY_USER_AGENT "Mozilla/5.0 (Linux; Android 4.4.2; Kindle Fire Build/KOT49H) AppleWebKit/537.36 (KHTML, like Gecko) Version/4.0 Chrome/30.0.0.0 Safari/537.36"
 
@@ -124,9 +125,44 @@ KykkyNetwork& KykkyNetwork::instance() {
     return inst;
 }
 
-void KykkyNetwork::init() {
+// curl/TLS 全局初始化放到第一次网络请求时 (不用云同步的用户完全不付这个开销)
+// pthread_once 保证多个后台线程同时发起第一次请求时也只初始化一次
+static pthread_once_t s_curl_once = PTHREAD_ONCE_INIT;
+
+static void curl_global_init_once() {
     curl_global_init(CURL_GLOBAL_DEFAULT);
-    
+}
+
+void KykkyNetwork::ensure_curl() {
+    pthread_once(&s_curl_once, curl_global_init_once);
+}
+
+// —— 复用的 easy handle ——
+// 一次同步里的几个请求 (探测、状态检查、上传) 都发往同一域名，
+// 复用同一个 handle 可以沿用已建立的连接、DNS 缓存和 TLS 会话，省掉重复握手。
+// handle 同一时间只能被一个请求使用，后台线程之间用互斥锁排队；
+// 每次取出时 curl_easy_reset 清掉上次的选项，连接和缓存不受影响
+CURL* KykkyNetwork::acquire_curl() {
+    ensure_curl();
+    pthread_mutex_lock(&curl_mutex_);
+    if (!curl_) {
+        curl_ = curl_easy_init();
+    } else {
+        curl_easy_reset(curl_);
+    }
+    if (curl_) {
+        // 多线程下不能用信号实现 DNS 超时
+        curl_easy_setopt(curl_, CURLOPT_NOSIGNAL, 1L);
+    }
+    return curl_;
+}
+
+void KykkyNetwork::release_curl() {
+    pthread_mutex_unlock(&curl_mutex_);
+}
+
+// 启动时只读取概览页同步状态需要的本地小文件，不做任何网络初始化
+void KykkyNetwork::init() {
     if (g_share_domain.empty()) {
         g_share_domain = "reading.tqhyg.net";
     }
@@ -165,11 +201,11 @@ std::string KykkyNetwork::extract_json_value(const std::string& json, const std:
 
 std::string KykkyNetwork::http_get(const std::string& url) {
     CURL *curl;
-    CURLcode res;
+    CURLcode res = CURLE_OK;
     std::string readBuffer;
     last_error_ = "";
 
-    curl = curl_easy_init();
+    curl = acquire_curl();
     if(curl) {
         curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 5L);
         curl_easy_setopt(curl, CURLOPT_TIMEOUT, 10L);
@@ -191,22 +227,22 @@ std::string KykkyNetwork::http_get(const std::string& url) {
 
         res = curl_easy_perform(curl);
         curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
         if (res != CURLE_OK) {
             last_error_ = curl_easy_strerror(res);
-            return "";
+            readBuffer.clear();
         }
     }
+    release_curl();
     return readBuffer;
 }
 
 std::string KykkyNetwork::http_post(const std::string& url, const std::string& data) {
     // 仅用于简单 POST
     CURL *curl;
-    CURLcode res;
+    CURLcode res = CURLE_OK;
     std::string readBuffer;
 
-    curl = curl_easy_init();
+    curl = acquire_curl();
     if(curl) {
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         curl_easy_setopt(curl, CURLOPT_USERAGENT, MY_USER_AGENT);
@@ -228,15 +264,15 @@ std::string KykkyNetwork::http_post(const std::string& url, const std::string& d
 
         res = curl_easy_perform(curl);
         curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
     }
+    release_curl();
     return readBuffer;
 }
 
 // 复杂上传
 std::string KykkyNetwork::http_post_files(const std::string& url, const std::vector<std::string>& file_paths, long today, long month) {
     CURL *curl;
-    CURLcode res;
+    CURLcode res = CURLE_OK;
     std::string readBuffer;
 
     struct curl_httppost *formpost = NULL;
@@ -254,7 +290,7 @@ std::string KykkyNetwork::http_post_files(const std::string& url, const std::vec
         }
     }
 
-    curl = curl_easy_init();
+    curl = acquire_curl();
     if(curl) {
         std::string full_url = url + "?today_seconds=" + std::to_string(today) + "&month_seconds=" + std::to_string(month);
 
@@ -279,13 +315,12 @@ std::string KykkyNetwork::http_post_files(const std::string& url, const std::vec
         res = curl_easy_perform(curl);
 
         curl_slist_free_all(headers);
-        curl_easy_cleanup(curl);
-        curl_formfree(formpost);
-
-        if (res != CURLE_OK) return "Network Error: " + std::string(curl_easy_strerror(res));
-    } else {
-        return "Curl init failed";
     }
+    release_curl();
+    curl_formfree(formpost);
+
+    if (!curl) return "Curl init failed";
+    if (res != CURLE_OK) return "Network Error: " + std::string(curl_easy_strerror(res));
 
     // 检查服务端返回
     std::string status = extract_json_value(readBuffer, "status");
@@ -297,12 +332,13 @@ std::string KykkyNetwork::http_post_files(const std::string& url, const std::vec
 
 bool KykkyNetwork::check_internet() {
     CURL *curl;
-    CURLcode res;
+    CURLcode res = CURLE_OK;
     last_error_ = "";
 
-    curl = curl_easy_init();
+    curl = acquire_curl();
     if(curl) {
-        std::string url = "http://" + domain + "/style.css";
+        // 与其它接口同走 https，探测时建立的连接留给随后的请求复用
+        std::string url = "https://" + domain + "/style.css";
         curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
         curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 3L);
         curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
@@ -312,13 +348,12 @@ bool KykkyNetwork::check_internet() {
         curl_easy_setopt(curl, CURLOPT_USERAGENT, "Kykky-Kindle-Client/1.0");
 
         res = curl_easy_perform(curl);
-        curl_easy_cleanup(curl);
         if (res != CURLE_OK) {
             last_error_ = curl_easy_strerror(res);
         }
-        return (res == CURLE_OK);
     }
-    return false;
+    release_curl();
+    return curl && res == CURLE_OK;
 }
 
 void KykkyNetwork::ensure_wifi_on() {
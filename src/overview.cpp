@@ -3,43 +3,30 @@
 #include "types.hpp"
 #include "utils.hpp"
 #include "network.hpp"
+#include "dataprocess.hpp"
 #include "overview.hpp"
 
-// —— 概览页 ——
-GtkWidget* create_overview_page() {
-    // 最外层白底
-    GtkWidget *eventbox = gtk_event_box_new();
-    gtk_widget_modify_bg(eventbox, GTK_STATE_NORMAL, &white);
-
-    GtkWidget *align_top = gtk_alignment_new(1, 0, 0, 0); // 右上对齐
-    KykkyNetwork &net = KykkyNetwork::instance();
-    std::string top_text = net.get_user_info().is_logged_in ? 
-                           "已同步: " + net.get_last_sync_text() : 
-                           "未登录";
-    
-    GtkWidget *lbl_top_status = gtk_label_new(top_text.c_str());
-    PangoFontDescription *tiny_font = pango_font_description_from_string("Sans 8");
-    gtk_widget_modify_font(lbl_top_status, tiny_font);
-    g_ui_handles.lbl_overview_sync_time = lbl_top_status;
-
-    gtk_container_add(GTK_CONTAINER(align_top), lbl_top_status);
+static OverviewWidgets *s_overview = NULL;
 
-    // 居中用的对齐控件
-    GtkWidget *align = gtk_alignment_new(0.5, 0.5, 0, 0);
-    gtk_container_add(GTK_CONTAINER(eventbox), align);
+// 按当前 Stats 版本刷新概览页文字 (启动时先显示快照数据，解析完日志后再调用一次)
+void update_overview_page() {
+    OverviewWidgets *ov = s_overview;
+    if (!ov) return;
 
-    GtkWidget *vbox = gtk_vbox_new(FALSE, 20);
-    gtk_container_add(GTK_CONTAINER(align), vbox);
+    StatsRef stats = stats_current();
+    // 查询某天总秒数，无记录返回 0
+    auto day_seconds = [&](time_t day) -> long {
+        auto it = stats->history_map.find(day);
+        return (it != stats->history_map.end()) ? it->second : 0;
+    };
 
-    gtk_box_pack_start(GTK_BOX(vbox), align_top, FALSE, FALSE, 0);
-
-    bool today_target_met = g_stats.today_seconds >= (g_daily_target_minutes * 60);
+    bool today_target_met = stats->today_seconds >= (g_daily_target_minutes * 60);
     char target_status[128];
     
     if (today_target_met) {
         snprintf(target_status, sizeof(target_status), "今天的阅读目标已完成！");
     } else {
-        long remaining = (g_daily_target_minutes * 60) - g_stats.today_seconds;
+        long remaining = (g_daily_target_minutes * 60) - stats->today_seconds;
         snprintf(target_status, sizeof(target_status), "还差 %ld 分钟达成今日阅读目标！", 
                  remaining/60 + (remaining%60 > 0 ? 1 : 0));
     }
@@ -51,14 +38,14 @@ GtkWidget* create_overview_page() {
     time_t loop_day = get_day_start(now);
     
     // 如果今天已经达标，从今天开始算；如果今天还没达标，从昨天开始算
-    if (g_stats.history_map[loop_day] < target_sec) {
+    if (day_seconds(loop_day) < target_sec) {
         loop_day -= 24 * 3600; // 回退到昨天
     }
 
     // 向前回溯统计
     while (true) {
         // 查找该日期是否有记录且达标
-        if (g_stats.history_map.count(loop_day) && g_stats.history_map[loop_day] >= target_sec) {
+        if (day_seconds(loop_day) >= target_sec) {
             consecutive_days++;
             loop_day -= 24 * 3600; // 前一天
         } else {
@@ -78,7 +65,7 @@ GtkWidget* create_overview_page() {
     // 遍历本月每一天
     for (time_t d = m_start; d < m_end_bound; d += 24 * 3600) {
         if (d > now) break; // 未来的日子不算
-        if (g_stats.history_map.count(d) && g_stats.history_map[d] >= target_sec) {
+        if (day_seconds(d) >= target_sec) {
             month_target_days++;
         }
     }
@@ -88,29 +75,93 @@ GtkWidget* create_overview_page() {
     snprintf(consecutive_str, sizeof(consecutive_str), "连续达成目标 %d 天", consecutive_days);
     snprintf(month_target_str, sizeof(month_target_str), "本月目标达成 %d 天", month_target_days);
 
-    // 创建标签
-    GtkWidget *label_target_status = gtk_label_new(target_status);
-    GtkWidget *label_consecutive = gtk_label_new(consecutive_str);
-    GtkWidget *label_month_target = gtk_label_new(month_target_str);
+    char buf_today[64], buf_total[64];
+    format_hms(stats->today_seconds, buf_today, sizeof(buf_today));
+    format_hms(stats->total_seconds, buf_total, sizeof(buf_total));
+
+    gtk_label_set_text(GTK_LABEL(ov->label_target_status), target_status);
+    gtk_label_set_text(GTK_LABEL(ov->label_today_time), buf_today);
+    gtk_label_set_text(GTK_LABEL(ov->label_total_time), buf_total);
+    gtk_label_set_text(GTK_LABEL(ov->label_consecutive), consecutive_str);
+    gtk_label_set_text(GTK_LABEL(ov->label_month_target), month_target_str);
+
+    // 数据仍来自上次保存的快照时给出提示
+    gtk_label_set_text(GTK_LABEL(ov->label_provisional),
+                       stats->provisional ? "正在读取新的阅读记录..." : "");
+    if (stats->provisional) gtk_widget_show(ov->progress_bar);
+    else gtk_widget_hide(ov->progress_bar);
+}
+
+// 更新后台读取进度 (由主循环定时调用)
+void update_overview_progress(const LoadProgress &progress) {
+    OverviewWidgets *ov = s_overview;
+    if (!ov) return;
+
+    char buf[64];
+    long long total = progress.bytes_total;
+    if (progress.preparing) {
+        gtk_progress_bar_pulse(GTK_PROGRESS_BAR(ov->progress_bar));
+        gtk_progress_bar_set_text(GTK_PROGRESS_BAR(ov->progress_bar), "正在整理历史记录...");
+    } else if (total > 0) {
+        double fraction = (double)progress.bytes_done / (double)total;
+        if (fraction > 1.0) fraction = 1.0;
+        snprintf(buf, sizeof(buf), "已读取 %ld 条记录", (long)progress.records);
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(ov->progress_bar), fraction);
+        gtk_progress_bar_set_text(GTK_PROGRESS_BAR(ov->progress_bar), buf);
+    }
+}
+
+// —— 概览页 ——
+GtkWidget* create_overview_page() {
+    // 最外层白底
+    GtkWidget *eventbox = gtk_event_box_new();
+    gtk_widget_modify_bg(eventbox, GTK_STATE_NORMAL, &white);
+
+    GtkWidget *align_top = gtk_alignment_new(1, 0, 0, 0); // 右上对齐
+    KykkyNetwork &net = KykkyNetwork::instance();
+    std::string top_text = net.get_user_info().is_logged_in ? 
+                           "已同步: " + net.get_last_sync_text() : 
+                           "未登录";
+    
+    GtkWidget *lbl_top_status = gtk_label_new(top_text.c_str());
+    PangoFontDescription *tiny_font = pango_font_description_from_string("Sans 8");
+    gtk_widget_modify_font(lbl_top_status, tiny_font);
+    g_ui_handles.lbl_overview_sync_time = lbl_top_status;
+
+    gtk_container_add(GTK_CONTAINER(align_top), lbl_top_status);
+
+    // 居中用的对齐控件
+    GtkWidget *align = gtk_alignment_new(0.5, 0.5, 0, 0);
+    gtk_container_add(GTK_CONTAINER(eventbox), align);
+
+    GtkWidget *vbox = gtk_vbox_new(FALSE, 20);
+    gtk_container_add(GTK_CONTAINER(align), vbox);
+
+    gtk_box_pack_start(GTK_BOX(vbox), align_top, FALSE, FALSE, 0);
+
+    // 创建标签 (文本由 update_overview_page 填写)
+    GtkWidget *label_provisional = gtk_label_new("");
+    GtkWidget *progress_bar = gtk_progress_bar_new();
+    // 显隐由 update_overview_page 控制，不受 gtk_widget_show_all 影响
+    gtk_widget_set_no_show_all(progress_bar, TRUE);
+    GtkWidget *label_target_status = gtk_label_new("");
+    GtkWidget *label_consecutive = gtk_label_new("");
+    GtkWidget *label_month_target = gtk_label_new("");
     
     // 设置字体大小
     PangoFontDescription *font_small = pango_font_description_from_string("Sans 16");
     gtk_widget_modify_font(label_target_status, font_small);
     gtk_widget_modify_font(label_consecutive, font_small);
     gtk_widget_modify_font(label_month_target, font_small);
-
-
-    char buf_today[64], buf_total[64];
-    format_hms(g_stats.today_seconds, buf_today, sizeof(buf_today));
-    format_hms(g_stats.total_seconds, buf_total, sizeof(buf_total));
+    gtk_widget_modify_font(label_provisional, tiny_font);
 
     // 今日时长
     GtkWidget *label_today_title = gtk_label_new("今日时长");
-    GtkWidget *label_today_time  = gtk_label_new(buf_today);
+    GtkWidget *label_today_time  = gtk_label_new("");
 
     // 总计阅读
     GtkWidget *label_total_title = gtk_label_new("总计阅读");
-    GtkWidget *label_total_time  = gtk_label_new(buf_total);
+    GtkWidget *label_total_time  = gtk_label_new("");
 
     // 标题字体
     PangoFontDescription *font_title = pango_font_description_from_string("Sans 22");
@@ -141,6 +192,8 @@ GtkWidget* create_overview_page() {
     gtk_misc_set_alignment(GTK_MISC(label_month_target), 0.5, 0.5);
 
     // 添加到vbox
+    gtk_box_pack_start(GTK_BOX(vbox), label_provisional, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), progress_bar, FALSE, FALSE, 0);
     gtk_box_pack_start(GTK_BOX(vbox), label_target_status, FALSE, FALSE, 5);
     
     GtkWidget *sep1 = gtk_hseparator_new();
@@ -158,6 +211,19 @@ GtkWidget* create_overview_page() {
     gtk_box_pack_start(GTK_BOX(vbox), label_month_target, FALSE, FALSE, 5);
 
     pango_font_description_free(font_small);
+    pango_font_description_free(tiny_font);
+
+    OverviewWidgets *ov = (OverviewWidgets*)g_malloc0(sizeof(OverviewWidgets));
+    ov->label_provisional = label_provisional;
+    ov->progress_bar = progress_bar;
+    ov->label_target_status = label_target_status;
+    ov->label_today_time = label_today_time;
+    ov->label_total_time = label_total_time;
+    ov->label_consecutive = label_consecutive;
+    ov->label_month_target = label_month_target;
+    s_overview = ov;
+
+    update_overview_page();
 
     return eventbox;
 }
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include <climits>
+#include <cstring>
+#include <ctime>
+
+#include "payload.hpp"
+
+const int PAYLOAD_VERSION = 1;
+
+// —— 基本字段 ——
+static void put_uint(std::string &out, unsigned long v) {
+    while (v >= 0x80) {
+        out.push_back((char)((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back((char)v);
+}
+
+static void put_str(std::string &out, const std::string &s) {
+    put_uint(out, s.size());
+    out += s;
+}
+
+static void put_series(std::string &out, const long *seconds, size_t n) {
+    put_uint(out, n);
+
+    // 没读书的日子只占位图里的一位
+    std::string bitmap((n + 7) / 8, '\0');
+    std::string values;
+    for (size_t i = 0; i < n; i++) {
+        long minutes = seconds[i] > 0 ? (seconds[i] + 59) / 60 : 0;
+        if (minutes == 0) continue;
+        bitmap[i / 8] |= (char)(1 << (i % 8));
+        put_uint(values, minutes);
+    }
+    out += bitmap;
+    out += values;
+}
+
+static std::string begin_payload(PayloadKind kind) {
+    return std::string(1, (char)((kind << 4) | PAYLOAD_VERSION));
+}
+
+// —— 各类型 ——
+std::string payload_month_share(int year, int month, int goal_minutes,
+                                const std::vector<long> &day_seconds, const long buckets[12]) {
+    std::string out = begin_payload(PAYLOAD_MONTH_SHARE);
+    put_uint(out, year);
+    put_uint(out, month);
+    put_uint(out, goal_minutes);
+    put_series(out, day_seconds.data(), day_seconds.size());
+    put_series(out, buckets, 12);
+    return out;
+}
+
+std::string payload_fast_sync(const std::string &device_code, long today_seconds, long month_seconds) {
+    std::string out = begin_payload(PAYLOAD_FAST_SYNC);
+    put_str(out, device_code);
+    put_uint(out, today_seconds > 0 ? today_seconds : 0);
+    put_uint(out, month_seconds > 0 ? month_seconds : 0);
+    return out;
+}
+
+std::string payload_year_share(int year, int goal_minutes, const std::vector<long> &day_seconds) {
+    std::string out = begin_payload(PAYLOAD_YEAR_SHARE);
+    put_uint(out, year);
+    put_uint(out, goal_minutes);
+    put_series(out, day_seconds.data(), day_seconds.size());
+    return out;
+}
+
+std::string payload_history(const std::string &device_code, time_t first_day,
+                            const std::vector<long> &day_seconds) {
+    // 只取本地日期，按 UTC 换算天数，与时区和夏令时无关
+    struct tm local;
+    localtime_r(&first_day, &local);
+    struct tm date;
+    memset(&date, 0, sizeof(date));
+    date.tm_year = local.tm_year;
+    date.tm_mon = local.tm_mon;
+    date.tm_mday = local.tm_mday;
+    long epoch_day = (long)(timegm(&date) / 86400);
+
+    std::string out = begin_payload(PAYLOAD_HISTORY);
+    put_str(out, device_code);
+    put_uint(out, epoch_day > 0 ? epoch_day : 0);
+    put_series(out, day_seconds.data(), day_seconds.size());
+    return out;
+}
+
+// —— 解码 ——
+// 与上面的编码一一对应，供测试和工具核对格式；任何越界、截断或多余字节都视为无效
+struct PayloadReader {
+    const std::string &data;
+    size_t pos;
+};
+
+static bool get_uint(PayloadReader &r, unsigned long &v) {
+    v = 0;
+    for (int shift = 0; shift < (int)sizeof(v) * 8; shift += 7) {
+        if (r.pos >= r.data.size()) return false;
+        unsigned char c = r.data[r.pos++];
+        v |= (unsigned long)(c & 0x7F) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+static bool get_int(PayloadReader &r, int &v) {
+    unsigned long u;
+    if (!get_uint(r, u) || u > 0x7FFFFFFFul) return false;
+    v = (int)u;
+    return true;
+}
+
+static bool get_long(PayloadReader &r, long &v) {
+    unsigned long u;
+    if (!get_uint(r, u) || u > (unsigned long)LONG_MAX) return false;
+    v = (long)u;
+    return true;
+}
+
+static bool get_str(PayloadReader &r, std::string &s) {
+    unsigned long n;
+    if (!get_uint(r, n) || n > r.data.size() - r.pos) return false;
+    s = r.data.substr(r.pos, n);
+    r.pos += n;
+    return true;
+}
+
+static bool get_series(PayloadReader &r, std::vector<long> &minutes) {
+    unsigned long n;
+    // 每天至少占位图的 1 位，天数不可能超过剩余字节数的 8 倍
+    if (!get_uint(r, n) || n > (r.data.size() - r.pos) * 8) return false;
+    size_t bitmap = r.pos;
+    r.pos += (n + 7) / 8;
+
+    minutes.assign(n, 0);
+    for (size_t i = 0; i < n; i++) {
+        if (!(r.data[bitmap + i / 8] & (1 << (i % 8)))) continue;
+        if (!get_long(r, minutes[i])) return false;
+    }
+    return true;
+}
+
+bool payload_decode(const std::string &data, DecodedPayload &out) {
+    out = DecodedPayload();
+    if (data.empty()) return false;
+
+    unsigned char head = data[0];
+    if ((head & 0x0F) != PAYLOAD_VERSION) return false;
+    out.kind = (PayloadKind)(head >> 4);
+
+    PayloadReader r = {data, 1};
+    bool ok;
+    switch (out.kind) {
+    case PAYLOAD_MONTH_SHARE:
+        ok = get_int(r, out.year) && get_int(r, out.month) && get_int(r, out.goal_minutes)
+          && get_series(r, out.day_minutes) && get_series(r, out.bucket_minutes)
+          && out.bucket_minutes.size() == 12;
+        break;
+    case PAYLOAD_FAST_SYNC:
+        ok = get_str(r, out.device_code) && get_long(r, out.today_seconds) && get_long(r, out.month_seconds);
+        break;
+    case PAYLOAD_YEAR_SHARE:
+        ok = get_int(r, out.year) && get_int(r, out.goal_minutes) && get_series(r, out.day_minutes);
+        break;
+    case PAYLOAD_HISTORY:
+        ok = get_str(r, out.device_code) && get_long(r, out.first_epoch_day) && get_series(r, out.day_minutes);
+        break;
+    default:
+        ok = false;
+        break;
+    }
+    return ok && r.pos == data.size();
+}
@@ -0,0 +1,59 @@
+#include <gtk/gtk.h>
+#include <time.h>
+#include <deque>
+#include <utility>
+
+#include "prefetch.hpp"
+#include "trace.hpp"
+
+// 每轮空闲回调最多占用的时间，超出后把剩余任务留到下一轮
+static const long long PREFETCH_SLICE_US = 20000;
+
+static std::deque<std::pair<PrefetchGroup, PrefetchTask>> s_tasks;
+static guint s_source = 0;
+
+static long long now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static gboolean run_prefetch(gpointer data) {
+    long long deadline = now_us() + PREFETCH_SLICE_US;
+
+    while (!s_tasks.empty()) {
+        // 点击等输入优先，留到下一轮空闲再继续
+        if (gtk_events_pending()) return TRUE;
+
+        PrefetchTask task = s_tasks.front().second;
+        s_tasks.pop_front();
+        {
+            TRACE_SCOPE("prefetch_task");
+            task();
+        }
+
+        if (now_us() >= deadline) break;
+    }
+
+    if (!s_tasks.empty()) return TRUE;
+    s_source = 0;
+    return FALSE;
+}
+
+void prefetch_add(PrefetchGroup group, PrefetchTask task) {
+    s_tasks.push_back(std::make_pair(group, task));
+    if (s_source == 0) {
+        s_source = g_idle_add_full(G_PRIORITY_LOW, run_prefetch, NULL, NULL);
+    }
+}
+
+void prefetch_cancel(PrefetchGroup group) {
+    for (auto it = s_tasks.begin(); it != s_tasks.end(); ) {
+        if (it->first == group) it = s_tasks.erase(it);
+        else ++it;
+    }
+    if (s_tasks.empty() && s_source != 0) {
+        g_source_remove(s_source);
+        s_source = 0;
+    }
+}
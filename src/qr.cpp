@@ -0,0 +1,176 @@
+#include <gtk/gtk.h>
+#include <cairo.h>
+#include <pthread.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <unordered_map>
+
+#include "qrcodegen.hpp"
+#include "qr.hpp"
+
+QrSymbol::~QrSymbol() {
+    if (mask) cairo_surface_destroy(mask);
+}
+
+// —— 编码缓存 ——
+// 键是内容哈希，命中后再比对原文防止碰撞。同时打开的二维码很少，超过上限整体清空
+static std::unordered_map<size_t, QrRef> s_qr_cache;
+static pthread_mutex_t s_qr_mutex = PTHREAD_MUTEX_INITIALIZER;
+static const size_t QR_CACHE_MAX = 16;
+
+static QrRef cache_find_locked(size_t key, const std::string &text) {
+    auto it = s_qr_cache.find(key);
+    if (it != s_qr_cache.end() && it->second->text == text) return it->second;
+    return QrRef();
+}
+
+QrRef qr_lookup(const std::string &text) {
+    size_t key = std::hash<std::string>()(text);
+    pthread_mutex_lock(&s_qr_mutex);
+    QrRef ref = cache_find_locked(key, text);
+    pthread_mutex_unlock(&s_qr_mutex);
+    return ref;
+}
+
+static std::shared_ptr<QrSymbol> encode_symbol(const std::string &text) {
+    std::shared_ptr<QrSymbol> sym(new QrSymbol());
+    sym->text = text;
+
+    try {
+        // Ecc::LOW 对于屏幕扫描足够了，生成的码点较少，更容易识别
+        qrcodegen::QrCode qr = qrcodegen::QrCode::encodeText(text.c_str(), qrcodegen::QrCode::Ecc::LOW);
+        int n = qr.getSize();
+
+        cairo_surface_t *mask = cairo_image_surface_create(CAIRO_FORMAT_A8, n, n);
+        unsigned char *data = cairo_image_surface_get_data(mask);
+        int stride = cairo_image_surface_get_stride(mask);
+        for (int y = 0; y < n; y++) {
+            unsigned char *row = data + y * stride;
+            for (int x = 0; x < n; x++) {
+                row[x] = qr.getModule(x, y) ? 0xFF : 0x00;
+            }
+        }
+        cairo_surface_mark_dirty(mask);
+
+        sym->size = n;
+        sym->mask = mask;
+    } catch (const std::exception &e) {
+        // 内容超出单个二维码容量，缓存空结果，避免每次重绘都重试
+        fprintf(stderr, "QR encode failed: %s\n", e.what());
+    }
+    return sym;
+}
+
+QrRef qr_encode_uncached(const std::string &text) {
+    return encode_symbol(text);
+}
+
+QrRef qr_encode(const std::string &text) {
+    QrRef ref = qr_lookup(text);
+    if (ref) return ref;
+
+    // 编码不持锁，两个线程同时编码同一内容时后写入的覆盖先写入的，结果相同
+    ref = encode_symbol(text);
+
+    size_t key = std::hash<std::string>()(text);
+    pthread_mutex_lock(&s_qr_mutex);
+    if (s_qr_cache.size() >= QR_CACHE_MAX) s_qr_cache.clear();
+    s_qr_cache[key] = ref;
+    pthread_mutex_unlock(&s_qr_mutex);
+    return ref;
+}
+
+// —— 绘制 ——
+void qr_paint(cairo_t *cr, const QrSymbol &qr, double x, double y, double side) {
+    if (!qr.mask) return;
+
+    // 放大倍数取整，每个模块占相同像素数，边缘锐利
+    double scale = side / qr.size;
+    if (scale >= 1) scale = floor(scale);
+    double off = (side - scale * qr.size) / 2;
+
+    cairo_save(cr);
+    cairo_translate(cr, floor(x + off), floor(y + off));
+    cairo_scale(cr, scale, scale);
+    cairo_pattern_t *pat = cairo_pattern_create_for_surface(qr.mask);
+    cairo_pattern_set_filter(pat, CAIRO_FILTER_NEAREST);
+    cairo_mask(cr, pat);
+    cairo_pattern_destroy(pat);
+    cairo_restore(cr);
+}
+
+// —— 二维码控件 ——
+static gboolean on_qr_expose(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
+    const std::string *text = static_cast<const std::string*>(data);
+    cairo_t *cr = gdk_cairo_create(widget->window);
+
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    cairo_paint(cr);
+
+    // 只查缓存，编码在后台完成
+    QrRef qr = qr_lookup(*text);
+    if (qr) {
+        int width = widget->allocation.width;
+        int height = widget->allocation.height;
+        double side = std::min(width, height) * 0.8;
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        qr_paint(cr, *qr, (width - side) / 2, (height - side) / 2, side);
+    }
+
+    cairo_destroy(cr);
+    return FALSE;
+}
+
+static void free_qr_text(gpointer data) {
+    delete static_cast<std::string*>(data);
+}
+
+struct QrEncodeJob {
+    std::string text;
+    GtkWidget *widget;      // 持有引用，控件提前销毁也不会悬空
+};
+
+static gboolean qr_job_done_idle(gpointer data) {
+    QrEncodeJob *job = (QrEncodeJob *)data;
+    gtk_widget_queue_draw(job->widget);
+    g_object_unref(job->widget);
+    delete job;
+    return FALSE;
+}
+
+static void* qr_encode_thread(void *data) {
+    QrEncodeJob *job = (QrEncodeJob *)data;
+    qr_encode(job->text);
+    g_idle_add(qr_job_done_idle, job);
+    return NULL;
+}
+
+GtkWidget* qr_widget_new(const std::string &text, int side) {
+    GtkWidget *da = gtk_drawing_area_new();
+    gtk_widget_set_size_request(da, side, side);
+
+    std::string *owned = new std::string(text);
+    g_object_set_data_full(G_OBJECT(da), "qr_text", owned, free_qr_text);
+    g_signal_connect(G_OBJECT(da), "expose-event", G_CALLBACK(on_qr_expose), owned);
+
+    if (!qr_lookup(text)) {
+        QrEncodeJob *job = new QrEncodeJob();
+        job->text = text;
+        job->widget = GTK_WIDGET(g_object_ref(da));
+
+        pthread_t tid;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        if (pthread_create(&tid, &attr, qr_encode_thread, job) != 0) {
+            // 建线程失败时退回同步编码
+            qr_encode_thread(job);
+        }
+        pthread_attr_destroy(&attr);
+    }
+    return da;
+}
@@ -0,0 +1,210 @@
+#include <gtk/gtk.h>
+#include <cairo.h>
+#include <pthread.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+
+#include "utils.hpp"
+#include "qr.hpp"
+#include "qrseq.hpp"
+
+const size_t QRSEQ_CHUNK_BYTES = 120;
+
+// 墨水屏刷新一次约 300ms，留出余量让手机每帧都能对焦识别
+static const guint QRSEQ_FRAME_MS = 600;
+
+// —— 帧生成 ——
+static uint32_t crc32_ieee(const std::string &data) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char c : data) {
+        crc ^= c;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+// 校验帧 seq 覆盖的块号，算法见 qrseq.hpp，接收端必须逐位一致
+static std::vector<size_t> parity_members(uint32_t seq, size_t k) {
+    uint32_t x = seq * 0x9E3779B1u;
+    if (x == 0) x = 1;
+    auto next = [&x]() {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        return x;
+    };
+
+    size_t degree = std::min<size_t>(2 + next() % 2, k);
+    std::vector<size_t> members;
+    while (members.size() < degree) {
+        size_t idx = next() % k;
+        if (std::find(members.begin(), members.end(), idx) == members.end()) {
+            members.push_back(idx);
+        }
+    }
+    return members;
+}
+
+std::vector<std::string> qr_split_frames(const std::string &prefix, const std::string &payload) {
+    size_t k = std::max<size_t>(1, (payload.size() + QRSEQ_CHUNK_BYTES - 1) / QRSEQ_CHUNK_BYTES);
+
+    std::vector<std::string> chunks(k);
+    for (size_t i = 0; i < k; i++) {
+        chunks[i] = payload.substr(std::min(payload.size(), i * QRSEQ_CHUNK_BYTES), QRSEQ_CHUNK_BYTES);
+        chunks[i].resize(QRSEQ_CHUNK_BYTES, '\0');
+    }
+
+    char head[64];
+    snprintf(head, sizeof(head), "/%zu/%zu/%08x/", k, payload.size(), (unsigned)crc32_ieee(payload));
+
+    size_t parity = (k > 1) ? (k + 1) / 2 : 0;
+    std::vector<std::string> frames;
+    frames.reserve(k + parity);
+    for (size_t seq = 0; seq < k + parity; seq++) {
+        std::string body;
+        if (seq < k) {
+            body = chunks[seq];
+        } else {
+            body.assign(QRSEQ_CHUNK_BYTES, '\0');
+            for (size_t idx : parity_members((uint32_t)seq, k)) {
+                for (size_t b = 0; b < QRSEQ_CHUNK_BYTES; b++) body[b] ^= chunks[idx][b];
+            }
+        }
+        frames.push_back(prefix + std::to_string(seq) + head + base64url_encode(body));
+    }
+    return frames;
+}
+
+// —— 轮播控件 ——
+// 控件与后台编码线程共享同一状态，谁后结束谁释放
+struct QrSeqState {
+    std::vector<std::string> frames;
+    std::vector<QrRef> symbols;     // 与 frames 对应，编码完成前为空
+    pthread_mutex_t mutex;
+    std::atomic<bool> cancelled;
+    size_t current;                 // 当前显示的帧，只在 UI 线程读写
+    bool shown;                     // current 已画到屏幕上
+    guint timer;
+
+    QrSeqState() : cancelled(false), current(0), shown(false), timer(0) {
+        pthread_mutex_init(&mutex, NULL);
+    }
+    ~QrSeqState() {
+        pthread_mutex_destroy(&mutex);
+    }
+};
+
+typedef std::shared_ptr<QrSeqState> QrSeqRef;
+
+static QrRef frame_symbol(QrSeqState &st, size_t i) {
+    if (i >= st.symbols.size()) return QrRef();
+    pthread_mutex_lock(&st.mutex);
+    QrRef ref = st.symbols[i];
+    pthread_mutex_unlock(&st.mutex);
+    return ref;
+}
+
+static void* qrseq_encode_thread(void *data) {
+    QrSeqRef *job = static_cast<QrSeqRef*>(data);
+    QrSeqState &st = **job;
+
+    for (size_t i = 0; i < st.frames.size() && !st.cancelled; i++) {
+        QrRef ref = qr_encode_uncached(st.frames[i]);
+        pthread_mutex_lock(&st.mutex);
+        st.symbols[i] = ref;
+        pthread_mutex_unlock(&st.mutex);
+    }
+
+    delete job;
+    return NULL;
+}
+
+static gboolean on_qrseq_tick(gpointer data) {
+    GtkWidget *widget = GTK_WIDGET(data);
+    QrSeqState &st = **static_cast<QrSeqRef*>(g_object_get_data(G_OBJECT(widget), "qrseq_state"));
+
+    // 跳到下一个已编码的帧；只有一帧可用时不重绘，省一次墨水屏刷新
+    size_t n = st.frames.size();
+    for (size_t step = 1; step <= n; step++) {
+        size_t i = (st.current + step) % n;
+        if (frame_symbol(st, i)) {
+            if (i != st.current || !st.shown) {
+                st.current = i;
+                st.shown = false;
+                gtk_widget_queue_draw(widget);
+            }
+            break;
+        }
+    }
+    return TRUE;
+}
+
+static gboolean on_qrseq_expose(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
+    QrSeqState &st = **static_cast<QrSeqRef*>(data);
+    cairo_t *cr = gdk_cairo_create(widget->window);
+
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    cairo_paint(cr);
+
+    QrRef qr = frame_symbol(st, st.current);
+    st.shown = (bool)qr;
+    if (qr) {
+        int width = widget->allocation.width;
+        int height = widget->allocation.height;
+        double side = std::min(width, height) * 0.8;
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        qr_paint(cr, *qr, (width - side) / 2, (height - side) / 2, side);
+    }
+
+    cairo_destroy(cr);
+    return FALSE;
+}
+
+static void on_qrseq_destroy(GtkWidget *widget, gpointer data) {
+    QrSeqState &st = **static_cast<QrSeqRef*>(data);
+    if (st.timer) {
+        g_source_remove(st.timer);
+        st.timer = 0;
+    }
+    st.cancelled = true;
+}
+
+static void free_qrseq_state(gpointer data) {
+    delete static_cast<QrSeqRef*>(data);
+}
+
+GtkWidget* qr_sequence_widget_new(const std::vector<std::string> &frames, int side) {
+    GtkWidget *da = gtk_drawing_area_new();
+    gtk_widget_set_size_request(da, side, side);
+
+    QrSeqRef *state = new QrSeqRef(std::make_shared<QrSeqState>());
+    QrSeqState &st = **state;
+    st.frames = frames;
+    st.symbols.resize(frames.size());
+
+    g_object_set_data_full(G_OBJECT(da), "qrseq_state", state, free_qrseq_state);
+    g_signal_connect(G_OBJECT(da), "expose-event", G_CALLBACK(on_qrseq_expose), state);
+    g_signal_connect(G_OBJECT(da), "destroy", G_CALLBACK(on_qrseq_destroy), state);
+
+    if (frames.empty()) return da;
+
+    // 第一帧出来后由定时器贴上，之后每次只换一张已编码好的蒙版
+    st.timer = g_timeout_add(QRSEQ_FRAME_MS, on_qrseq_tick, da);
+
+    QrSeqRef *job = new QrSeqRef(*state);
+    pthread_t tid;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&tid, &attr, qrseq_encode_thread, job) != 0) {
+        // 建线程失败时退回同步编码
+        qrseq_encode_thread(job);
+    }
+    pthread_attr_destroy(&attr);
+    return da;
+}
@@ -0,0 +1,144 @@
+#include <gtk/gtk.h>
+#include <cairo.h>
+#include <algorithm>
+#include <cmath>
+
+#include "types.hpp"
+#include "render.hpp"
+
+// A8 目标只有 alpha 通道，存的是 "墨量" (1 - 灰度)，量化到面板的 16 级
+static bool is_gray_target(cairo_t *cr) {
+    return cairo_surface_get_content(cairo_get_target(cr)) == CAIRO_CONTENT_ALPHA;
+}
+
+void set_gray(cairo_t *cr, double gray) {
+    if (is_gray_target(cr)) {
+        double ink = floor((1.0 - gray) * 15 + 0.5) / 15;
+        // SOURCE 直接写入墨量，浅色 (包括白色) 才能盖住深色
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        cairo_set_source_rgba(cr, 0, 0, 0, ink);
+    } else {
+        cairo_set_source_rgb(cr, gray, gray, gray);
+    }
+}
+
+void chart_cache_reset(ChartCache &cache) {
+    if (cache.surface) {
+        cairo_surface_destroy(cache.surface);
+        cache.surface = NULL;
+    }
+}
+
+// 按当前绘制模式新建 surface 并画入 v 的图表
+static void render_chart(ChartCache &cache, cairo_surface_t *like, int w, int h,
+                         const ViewData &v, ChartRenderFunc render) {
+    chart_cache_reset(cache);
+    if (g_gray_render) {
+        // 8 位灰度：内存和贴图带宽都是 RGB 的 1/4
+        cache.surface = cairo_image_surface_create(CAIRO_FORMAT_A8, w, h);
+    } else {
+        // 与窗口同类型的 surface，贴图时不需要格式转换
+        cache.surface = cairo_surface_create_similar(like, CAIRO_CONTENT_COLOR, w, h);
+    }
+    cache.width = w;
+    cache.height = h;
+    cache.gray = g_gray_render;
+
+    cairo_t *scr = cairo_create(cache.surface);
+    if (cache.gray) {
+        // 图形只有水平/竖直边，墨水屏上关掉抗锯齿边缘更干净；文字仍保留灰度抗锯齿
+        cairo_set_antialias(scr, CAIRO_ANTIALIAS_NONE);
+    }
+    render(scr, v, w, h);
+    cairo_destroy(scr);
+}
+
+void chart_cache_paint(ChartCache &cache, GtkWidget *widget, GdkEventExpose *event,
+                       unsigned int version, ChartRenderFunc render) {
+    cairo_t *cr = gdk_cairo_create(gtk_widget_get_window(widget));
+
+    int w = widget->allocation.width;
+    int h = widget->allocation.height;
+
+    // 1. 尺寸、数据或绘制模式变化时重画离屏 surface
+    if (!cache.surface || cache.width != w || cache.height != h || cache.version != version
+        || cache.gray != g_gray_render) {
+        render_chart(cache, cairo_get_target(cr), w, h, g_view_data, render);
+        cache.version = version;
+    }
+
+    // 2. 只贴需要重绘的区域 (多个失效矩形时 region 比 area 的外接矩形更小)
+    gdk_cairo_region(cr, event->region);
+    cairo_clip(cr);
+    if (cache.gray) {
+        // 白底上按墨量印黑色
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_paint(cr);
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_mask_surface(cr, cache.surface, 0, 0);
+    } else {
+        cairo_set_source_surface(cr, cache.surface, 0, 0);
+        cairo_paint(cr);
+    }
+
+    cairo_destroy(cr);
+}
+
+bool chart_cache_prerender(ChartCache &img, GtkWidget *widget, const ViewData &v, ChartRenderFunc render) {
+    GdkWindow *win = gtk_widget_get_window(widget);
+    if (!win) return false;
+
+    cairo_t *cr = gdk_cairo_create(win);
+    render_chart(img, cairo_get_target(cr), widget->allocation.width, widget->allocation.height, v, render);
+    img.version = 0;
+    cairo_destroy(cr);
+    return true;
+}
+
+bool chart_cache_adopt(ChartCache &cache, ChartCache &img, GtkWidget *widget, unsigned int version) {
+    bool ok = img.surface
+           && img.width == widget->allocation.width
+           && img.height == widget->allocation.height
+           && img.gray == g_gray_render;
+    if (ok) {
+        chart_cache_reset(cache);
+        cache = img;
+        cache.version = version;
+        img.surface = NULL;
+    } else {
+        chart_cache_reset(img);
+    }
+    return ok;
+}
+
+// —— 按灰度批量填充 ——
+// 关闭时逐个矩形设色填充，供基准对比批量填充的收益
+static bool s_fill_batched = true;
+
+void fill_rects_set_batched(bool batched) {
+    s_fill_batched = batched;
+}
+
+void fill_rects_by_gray(cairo_t *cr, std::vector<GrayRect> &rects) {
+    if (!s_fill_batched) {
+        for (const GrayRect &r : rects) {
+            set_gray(cr, r.gray);
+            cairo_rectangle(cr, r.x, r.y, r.w, r.h);
+            cairo_fill(cr);
+        }
+        return;
+    }
+
+    std::sort(rects.begin(), rects.end(),
+              [](const GrayRect &a, const GrayRect &b) { return a.gray < b.gray; });
+
+    size_t i = 0;
+    while (i < rects.size()) {
+        double gray = rects[i].gray;
+        set_gray(cr, gray);
+        for (; i < rects.size() && rects[i].gray == gray; i++) {
+            cairo_rectangle(cr, rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+        }
+        cairo_fill(cr);
+    }
+}
@@ -6,13 +6,17 @@
 #include <vector>
 #include <gdk-pixbuf/gdk-pixbuf.h>
 
-#include "qrcodegen.hpp"
 #include "types.hpp"
 #include "utils.hpp"
 #include "dataprocess.hpp"
+#include "loader.hpp"
 #include "share.hpp"
 #include "network.hpp"
 #include "settingsui.hpp"
+#include "overview.hpp"
+#include "month.hpp"
+#include "qr.hpp"
+#include "qrseq.hpp"
 
 // —— 设置页辅助逻辑 ——
 
@@ -133,8 +137,8 @@ void on_reset_data(GtkButton *btn, gpointer user_data) {
         // 更新界面显示为 0 KiB
         gtk_label_set_text(GTK_LABEL(size_label), "0 KiB");
         
-        // 安全清理
-        read_logs_and_compute_stats(g_stats, g_view_year, g_view_month, true);
+        // 在后台重新读取：进行中的加载作废，完成后由加载回调发布并刷新各页
+        loader_restart();
     }
     
     // 销毁对话框
@@ -153,6 +157,12 @@ void on_target_change(GtkButton *btn, gpointer data) {
     if (new_target != g_daily_target_minutes) {
         g_daily_target_minutes = new_target;
         save_target_config();
+
+        // 日历灰度和概览的目标进度都依赖目标分钟数
+        set_month_view_data(g_view_data, g_view_data.month_year, g_view_data.month_month,
+                            g_view_data.month_day_seconds, g_daily_target_minutes);
+        month_view_data_changed();
+        update_overview_page();
         
         // 更新显示
         GtkWidget *label = GTK_WIDGET(g_object_get_data(G_OBJECT(btn), "target_label"));
@@ -162,65 +172,6 @@ void on_target_change(GtkButton *btn, gpointer data) {
     }
 }
 
-// —— 辅助函数：生成二维码图片 ——
-GtkWidget* create_qr_widget(const std::string& data) {
-    using namespace qrcodegen;
-
-    // 1. 生成二维码数据
-    // Ecc::LOW 对于屏幕扫描足够了，生成的码点较少，更容易识别
-    QrCode qr = QrCode::encodeText(data.c_str(), QrCode::Ecc::LOW);
-    
-    // 2. 计算尺寸
-    int module_size = qr.getSize(); // 二维码矩阵大小 (例如 21x21)
-    int scale = 8; 
-    int border = 2; 
-    
-    // 最终图片宽高
-    int real_size = (module_size + border * 2) * scale;
-
-    // 3. 创建 GdkPixbuf (RGB 格式, 无 Alpha 通道, 8位色深)
-    GdkPixbuf *pixbuf = gdk_pixbuf_new(GDK_COLORSPACE_RGB, FALSE, 8, real_size, real_size);
-    
-    if (!pixbuf) return gtk_label_new("QR Error"); // 防御性检查
-
-    int rowstride = gdk_pixbuf_get_rowstride(pixbuf);
-    guchar *pixels = gdk_pixbuf_get_pixels(pixbuf);
-    int n_channels = gdk_pixbuf_get_n_channels(pixbuf);
-
-    // 4. 填充像素数据
-    for (int y = 0; y < real_size; y++) {
-        for (int x = 0; x < real_size; x++) {
-            // 将像素坐标映射回二维码模块坐标
-            int qr_x = (x / scale) - border;
-            int qr_y = (y / scale) - border;
-
-            // 默认白色 (0xFF)
-            guchar color = 0xFF; 
-
-            // 如果坐标在二维码范围内，且该模块是黑色的
-            if (qr_x >= 0 && qr_x < module_size && qr_y >= 0 && qr_y < module_size) {
-                if (qr.getModule(qr_x, qr_y)) {
-                    color = 0x00; // 黑色
-                }
-            }
-
-            // 写入 RGB 数据
-            guchar *p = pixels + y * rowstride + x * n_channels;
-            p[0] = color; // R
-            p[1] = color; // G
-            p[2] = color; // B
-        }
-    }
-
-    // 5. 从 Pixbuf 创建 GtkImage
-    GtkWidget *img = gtk_image_new_from_pixbuf(pixbuf);
-    
-    // 释放 pixbuf 引用 (GtkImage 已经接管了)
-    g_object_unref(pixbuf);
-
-    return img;
-}
-
 // —— 云同步弹窗逻辑 (异步版) ——
 
 // 用 pthread 创建 detached 线程，兼容旧版 GLib
@@ -274,15 +225,13 @@ struct AsyncPollData {
     SyncDialogData *ddata;
     std::string token;
     std::string device_code;
-    long today_seconds;
-    long month_seconds;
+    StatsRef stats;
 };
 
 struct AsyncSyncData {
     SyncDialogData *ddata;
     std::string error;
-    long today_seconds;
-    long month_seconds;
+    StatsRef stats;
     GtkWidget *btn;
 };
 
@@ -300,8 +249,7 @@ struct AsyncCheckNetData {
 struct AsyncUploadData {
     SyncDialogData *ddata;
     std::string error;
-    long today_seconds;
-    long month_seconds;
+    StatsRef stats;
 };
 
 // ---- 异步回调：登录后自动上传 ----
@@ -329,7 +277,7 @@ static gboolean auto_upload_done_idle(gpointer data) {
 static gpointer auto_upload_thread(gpointer data) {
     AsyncUploadData *ud = (AsyncUploadData *)data;
     KykkyNetwork &net = KykkyNetwork::instance();
-    ud->error = net.upload_data(ud->today_seconds, ud->month_seconds);
+    ud->error = net.upload_data(ud->stats->today_seconds, ud->stats->month_seconds);
     g_idle_add(auto_upload_done_idle, ud);
     return NULL;
 }
@@ -358,8 +306,7 @@ static gboolean poll_login_done_idle(gpointer data) {
             // 异步上传数据
             AsyncUploadData *ud = new AsyncUploadData();
             ud->ddata = ddata;
-            ud->today_seconds = pd->today_seconds;
-            ud->month_seconds = pd->month_seconds;
+            ud->stats = pd->stats;
             ddata->ref();
             spawn_detached_thread(auto_upload_thread, ud);
         }
@@ -394,8 +341,7 @@ static gboolean on_poll_login(gpointer user_data) {
     AsyncPollData *pd = new AsyncPollData();
     pd->ddata = ddata;
     pd->device_code = ddata->pending_device_code;
-    pd->today_seconds = g_stats.today_seconds;
-    pd->month_seconds = g_stats.month_seconds;
+    pd->stats = stats_current();
 
     spawn_detached_thread(poll_login_thread, pd);
     return TRUE;
@@ -471,7 +417,7 @@ static gpointer do_sync_thread(gpointer data) {
         }
     }
 
-    sd->error = net.upload_data(sd->today_seconds, sd->month_seconds);
+    sd->error = net.upload_data(sd->stats->today_seconds, sd->stats->month_seconds);
     g_idle_add(do_sync_done_idle, sd);
     return NULL;
 }
@@ -488,8 +434,7 @@ static void on_do_sync(GtkButton *btn, gpointer user_data) {
     ddata->ref();
     AsyncSyncData *sd = new AsyncSyncData();
     sd->ddata = ddata;
-    sd->today_seconds = g_stats.today_seconds;
-    sd->month_seconds = g_stats.month_seconds;
+    sd->stats = stats_current();
     sd->btn = GTK_WIDGET(btn);
 
     spawn_detached_thread(do_sync_thread, sd);
@@ -566,7 +511,7 @@ static gboolean fetch_qr_done_idle(gpointer data) {
         } else {
             ddata->pending_device_code = qd->device_code;
 
-            GtkWidget *qr_img = create_qr_widget(qd->login_url);
+            GtkWidget *qr_img = qr_widget_new(qd->login_url, 300);
             gtk_box_pack_start(GTK_BOX(ddata->vbox), qr_img, TRUE, TRUE, 10);
             // 把二维码放在标题后面（位置1），状态label之前
             gtk_box_reorder_child(GTK_BOX(ddata->vbox), qr_img, 1);
@@ -614,15 +559,16 @@ static gboolean check_net_done_idle(gpointer data) {
         GtkWidget *lbl_offline = gtk_label_new("  当前无网络，可扫码快速同步  ");
         gtk_box_pack_start(GTK_BOX(ddata->offline_container), lbl_offline, FALSE, FALSE, 5);
 
-        std::string json_data = "{\"did\":\"" + net.get_device_code() + "\",\"today\":"
-                            + std::to_string(g_stats.today_seconds) + ",\"month\":"
-                            + std::to_string(g_stats.month_seconds) + "}";
+        GtkWidget *fast_qr = qr_widget_new(generate_fast_sync_url(net.get_device_code()), 300);
+        gtk_box_pack_start(GTK_BOX(ddata->offline_container), fast_qr, FALSE, FALSE, 5);
 
-        std::string b64 = base64_encode(json_data);
-        std::string fast_url = "https://" + g_share_domain + "/fastsync.php?data=" + b64;
+        // 全部历史装不进单个二维码，用多帧轮播；接收页打开后继续扫描
+        GtkWidget *lbl_history = gtk_label_new("  同步全部历史：打开页面后扫描下方动态二维码  ");
+        gtk_box_pack_start(GTK_BOX(ddata->offline_container), lbl_history, FALSE, FALSE, 5);
 
-        GtkWidget *fast_qr = create_qr_widget(fast_url);
-        gtk_box_pack_start(GTK_BOX(ddata->offline_container), fast_qr, FALSE, FALSE, 5);
+        GtkWidget *history_qr = qr_sequence_widget_new(
+            generate_history_sync_frames(net.get_device_code()), 300);
+        gtk_box_pack_start(GTK_BOX(ddata->offline_container), history_qr, FALSE, FALSE, 5);
 
         gtk_widget_show_all(ddata->offline_container);
 
@@ -1,76 +1,125 @@
+#include <cstring>
+
 #include "types.hpp"
 #include "utils.hpp"
+#include "dataprocess.hpp"
+#include "payload.hpp"
 #include "share.hpp"
-#include "qrcodegen.hpp"
+#include "qr.hpp"
+#include "qrseq.hpp"
+#include "sharecard.hpp"
+
+// —— 紧凑编码的链接 ——
+// 线上的 share.php / fastsync.php 只认旧版的明文参数，紧凑编码 (格式见 payload.hpp)
+// 走单独的路径，服务端还没部署新页面时也不会把新数据当成空分享或空同步
+static std::string compact_url(const char *path, const std::string &payload) {
+    return "https://" + g_share_domain + path + "?c=" + base64url_encode(payload);
+}
 
-// 生成分享URL
+// 生成分享URL。年月取自视图数据本身，与每日数据一定是同一个月
+// (g_view_year/g_view_month 在翻页时先变，数据要等翻页提交后才跟上)
 std::string generate_share_url() {
-    std::string url = "https://" + g_share_domain + "/share.php?";
-    
-    // 添加年月和目标
-    char buf[64];
-    snprintf(buf, sizeof(buf), "year=%d&month=%d&goal=%d", g_view_year, g_view_month, g_daily_target_minutes);
-    url += buf;
-    
-    // 添加当月每日数据
-    int days = g_stats.month_day_seconds.size();
-    for (int i = 0; i < days; i++) {
-        long minutes = (g_stats.month_day_seconds[i] + 59) / 60; // 秒转分钟（向上取整）
-        snprintf(buf, sizeof(buf), "&%d=%ld", i + 1, minutes);
-        url += buf;
-    }
-    
-    // 添加分时数据（d1-d12）
-    for (int i = 0; i < 12; i++) {
-        long minutes = (g_stats.view_daily_buckets[i] + 59) / 60;
-        snprintf(buf, sizeof(buf), "&d%d=%ld", i + 1, minutes);
-        url += buf;
-    }
-    
-    return url;
+    std::string data = payload_month_share(g_view_data.month_year, g_view_data.month_month,
+                                           g_daily_target_minutes,
+                                           g_view_data.month_day_seconds,
+                                           g_view_data.view_daily_buckets);
+    return compact_url("/s/", data);
 }
 
-gboolean draw_qrcode(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
-    const std::string *url = static_cast<const std::string*>(data);
-    if (!url || url->empty()) return FALSE;
-    
-    cairo_t *cr = gdk_cairo_create(widget->window);
-    
-    // 白色背景
-    cairo_set_source_rgb(cr, 1, 1, 1);
-    cairo_paint(cr);
-    
-    int width = widget->allocation.width;
-    int height = widget->allocation.height;
-    
-    // 使用 qrcodegen 生成 QR 码
-    const qrcodegen::QrCode qr = qrcodegen::QrCode::encodeText(
-        url->c_str(), 
-        qrcodegen::QrCode::Ecc::LOW  // 使用低级纠错，可容纳更多数据
-    );
-    
-    int qr_size = qr.getSize();  // QR 码的模块数
-    int qr_pixel_size = std::min(width, height) * 0.8;  // 绘制区域大小
-    double scale = qr_pixel_size / (double)qr_size;
-    int offset_x = (width - qr_pixel_size) / 2;
-    int offset_y = (height - qr_pixel_size) / 2;
-    
-    // 绘制二维码
-    cairo_set_source_rgb(cr, 0, 0, 0);
-    for (int y = 0; y < qr_size; y++) {
-        for (int x = 0; x < qr_size; x++) {
-            if (qr.getModule(x, y)) {
-                cairo_rectangle(cr, 
-                    offset_x + x * scale, 
-                    offset_y + y * scale, 
-                    scale, scale);
-                cairo_fill(cr);
-            }
-        }
+std::string generate_fast_sync_url(const std::string &device_code) {
+    StatsRef stats = stats_current();
+    return compact_url("/fs/", payload_fast_sync(device_code, stats->today_seconds, stats->month_seconds));
+}
+
+// —— 多帧二维码内容 ——
+// 扫到任意一帧都会打开接收页，接收页继续用摄像头收齐其余帧
+static std::string frame_prefix() {
+    return "https://" + g_share_domain + "/scan.php#";
+}
+
+// 从 day 起连续 count 天的秒数
+static std::vector<long> daily_seconds(const Stats &s, time_t day, int count) {
+    std::vector<long> out(count, 0);
+    for (int i = 0; i < count; i++) {
+        auto it = s.history_map.find(day);
+        if (it != s.history_map.end()) out[i] = it->second;
+        day = add_days(day, 1);
     }
-    
-    cairo_destroy(cr);
-    return FALSE;
+    return out;
+}
+
+static time_t year_start(int year) {
+    struct tm tmv;
+    memset(&tmv, 0, sizeof(tmv));
+    tmv.tm_year = year - 1900;
+    tmv.tm_mday = 1;
+    tmv.tm_isdst = -1;
+    return mktime(&tmv);
+}
+
+std::vector<std::string> generate_year_share_frames() {
+    StatsRef stats = stats_current();
+    int days = 0;
+    for (int m = 1; m <= 12; m++) days += days_in_month(g_view_year, m);
+
+    std::string payload = payload_year_share(g_view_year, g_daily_target_minutes,
+                                             daily_seconds(*stats, year_start(g_view_year), days));
+    return qr_split_frames(frame_prefix(), payload);
+}
+
+std::vector<std::string> generate_history_sync_frames(const std::string &device_code) {
+    StatsRef stats = stats_current();
+    time_t today, tomorrow;
+    get_today_bounds(today, tomorrow);
+
+    // 从第一条记录所在日到今天
+    time_t first = stats->history_map.empty() ? today : stats->history_map.begin()->first;
+    int days = 0;
+    for (time_t d = first; d <= today; d = add_days(d, 1)) days++;
+
+    std::string payload = payload_history(device_code, first, daily_seconds(*stats, first, days));
+    return qr_split_frames(frame_prefix(), payload);
+}
+
+// 本月单码与全年多帧之间切换
+static void on_year_toggle_clicked(GtkButton *btn, gpointer data) {
+    GtkWidget *qr_box = GTK_WIDGET(data);
+    bool showing_year = g_object_get_data(G_OBJECT(btn), "showing_year") != NULL;
+
+    GList *children = gtk_container_get_children(GTK_CONTAINER(qr_box));
+    for (GList *l = children; l; l = l->next) gtk_widget_destroy(GTK_WIDGET(l->data));
+    g_list_free(children);
+
+    GtkWidget *qr = showing_year ? qr_widget_new(generate_share_url(), 500)
+                                 : qr_sequence_widget_new(generate_year_share_frames(), 500);
+    gtk_box_pack_start(GTK_BOX(qr_box), qr, FALSE, FALSE, 0);
+    gtk_widget_show(qr);
+
+    g_object_set_data(G_OBJECT(btn), "showing_year", showing_year ? NULL : GINT_TO_POINTER(1));
+    gtk_button_set_label(btn, showing_year ? "分享全年 (动态二维码)" : "分享本月");
+}
+
+static void on_card_saved(const std::string &path, gpointer data) {
+    GtkWidget *button = GTK_WIDGET(data);
+    GtkWidget *label = GTK_WIDGET(g_object_get_data(G_OBJECT(button), "status_label"));
+
+    // 对话框可能已经关闭，控件仍被引用着，设置文字不会出错
+    std::string msg = path.empty() ? "保存失败" : "已保存到 " + path;
+    gtk_label_set_text(GTK_LABEL(label), msg.c_str());
+    gtk_widget_set_sensitive(button, TRUE);
+
+    g_object_unref(label);
+    g_object_unref(button);
+}
+
+static void on_save_card_clicked(GtkButton *btn, gpointer data) {
+    GtkWidget *label = GTK_WIDGET(g_object_get_data(G_OBJECT(btn), "status_label"));
+    gtk_label_set_text(GTK_LABEL(label), "正在生成...");
+    gtk_widget_set_sensitive(GTK_WIDGET(btn), FALSE);
+
+    g_object_ref(btn);
+    g_object_ref(label);
+    share_card_export_async(on_card_saved, btn);
 }
 
 void create_share_dialog() {
@@ -105,18 +154,26 @@ void create_share_dialog() {
     gtk_misc_set_alignment(GTK_MISC(label2), 0.5, 0.5);
     gtk_box_pack_start(GTK_BOX(vbox), label2, FALSE, FALSE, 10);
     
-    // 生成分享URL
-    static std::string share_url;  // 使用static确保指针有效
-    share_url = generate_share_url();
-    
-    // 创建绘图区域显示二维码
-    GtkWidget *drawing_area = gtk_drawing_area_new();
-    gtk_widget_set_size_request(drawing_area, 500, 500);
-    gtk_box_pack_start(GTK_BOX(vbox), drawing_area, FALSE, FALSE, 20);
-    
-    // 连接绘制事件
-    g_signal_connect(G_OBJECT(drawing_area), "expose-event",
-                     G_CALLBACK(draw_qrcode), (gpointer)&share_url);
+    // 生成分享URL，二维码在后台编码，对话框先弹出
+    GtkWidget *qr_box = gtk_vbox_new(FALSE, 0);
+    GtkWidget *qr_area = qr_widget_new(generate_share_url(), 500);
+    gtk_box_pack_start(GTK_BOX(qr_box), qr_area, FALSE, FALSE, 0);
+    gtk_box_pack_start(GTK_BOX(vbox), qr_box, FALSE, FALSE, 20);
+    
+    // 全年数据放不进一个二维码，改为多帧轮播
+    GtkWidget *button_year = gtk_button_new_with_label("分享全年 (动态二维码)");
+    g_signal_connect(G_OBJECT(button_year), "clicked",
+                     G_CALLBACK(on_year_toggle_clicked), qr_box);
+    gtk_box_pack_start(GTK_BOX(vbox), button_year, FALSE, FALSE, 5);
+    
+    // 保存分享图片 (后台生成，不阻塞对话框)
+    GtkWidget *label_card = gtk_label_new("");
+    GtkWidget *button_card = gtk_button_new_with_label("保存分享图片");
+    g_object_set_data(G_OBJECT(button_card), "status_label", label_card);
+    g_signal_connect(G_OBJECT(button_card), "clicked",
+                     G_CALLBACK(on_save_card_clicked), NULL);
+    gtk_box_pack_start(GTK_BOX(vbox), button_card, FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), label_card, FALSE, FALSE, 5);
     
     // 添加关闭按钮
     GtkWidget *button_close = gtk_button_new_with_label("关闭");
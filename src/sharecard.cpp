@@ -0,0 +1,155 @@
+#include <gtk/gtk.h>
+#include <cairo.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#include "types.hpp"
+#include "utils.hpp"
+#include "daily.hpp"
+#include "month.hpp"
+#include "share.hpp"
+#include "qr.hpp"
+#include "render.hpp"
+#include "trace.hpp"
+#include "sharecard.hpp"
+
+static const int SHARE_CARD_WIDTH = 1072;
+static const int SHARE_CARD_HEIGHT = 1448;
+
+// —— 版面 ——
+// [标题与关键数字 200] [月历 700] [当日分布 400] [二维码与说明 148]
+static const int CARD_HEADER_H = 200;
+static const int CARD_MONTH_H = 700;
+static const int CARD_DAY_H = 400;
+
+// 把图表画进 (0, y) 起、高 h 的横条
+static void render_band(cairo_t *cr, const ViewData &v, int y, int w, int h,
+                        ChartRenderFunc render) {
+    cairo_save(cr);
+    cairo_translate(cr, 0, y);
+    cairo_rectangle(cr, 0, 0, w, h);
+    cairo_clip(cr);
+    render(cr, v, w, h);
+    cairo_restore(cr);
+}
+
+void render_share_card(cairo_t *cr, const ShareCardData &d, int w, int h) {
+    set_gray(cr, 1);
+    cairo_paint(cr);
+
+    // 1. 标题与关键数字
+    const ViewData &v = d.view;
+    long target_sec = d.target_minutes * 60L;
+    int goal_days = 0;
+    for (size_t i = 0; i < v.month_day_seconds.size(); i++) {
+        if (v.month_day_seconds[i] >= target_sec) goal_days++;
+    }
+
+    char buf[128];
+    set_gray(cr, 0);
+    snprintf(buf, sizeof(buf), "%04d年%02d月 阅读统计", v.month_year, v.month_month);
+    cairo_set_font_size(cr, 60);
+    cairo_move_to(cr, 40, 80);
+    cairo_show_text(cr, buf);
+
+    snprintf(buf, sizeof(buf), "每日目标 %d 分钟，本月达标 %d 天", d.target_minutes, goal_days);
+    cairo_set_font_size(cr, 40);
+    cairo_move_to(cr, 40, 140);
+    cairo_show_text(cr, buf);
+
+    struct tm tmv;
+    localtime_r(&d.day, &tmv);
+    char time_str[64];
+    format_hms(v.view_daily_seconds, time_str, sizeof(time_str));
+    snprintf(buf, sizeof(buf), "%02d月%02d日 时长: %s", tmv.tm_mon + 1, tmv.tm_mday, time_str);
+    cairo_move_to(cr, 40, 190);
+    cairo_show_text(cr, buf);
+
+    // 2. 月历与当日分布，直接复用页面的绘制函数；月历灰度与标题使用同一个目标
+    ViewData month_view = v;
+    month_view.month_target_minutes = d.target_minutes;
+    render_band(cr, month_view, CARD_HEADER_H, w, CARD_MONTH_H, render_month_view);
+    render_band(cr, v, CARD_HEADER_H + CARD_MONTH_H, w, CARD_DAY_H, render_today_dist);
+
+    // 3. 右下角印上分享链接的二维码
+    int footer_y = CARD_HEADER_H + CARD_MONTH_H + CARD_DAY_H;
+    int qr_side = h - footer_y - 8;
+    if (qr_side > 0 && !d.share_url.empty()) {
+        QrRef qr = qr_encode(d.share_url);
+        set_gray(cr, 0);
+        qr_paint(cr, *qr, w - qr_side - 20, footer_y + 4, qr_side);
+
+        cairo_set_font_size(cr, 32);
+        cairo_move_to(cr, 40, footer_y + qr_side / 2 + 12);
+        cairo_show_text(cr, "扫码查看在线统计");
+    }
+}
+
+// —— 后台导出 ——
+struct ShareCardJob {
+    ShareCardData data;
+    std::string path;
+    bool ok;
+    ShareCardDoneFunc done;
+    gpointer user_data;
+};
+
+static gboolean share_card_done_idle(gpointer data) {
+    ShareCardJob *job = (ShareCardJob *)data;
+    job->done(job->ok ? job->path : std::string(), job->user_data);
+    delete job;
+    return FALSE;
+}
+
+static void* share_card_thread(void *data) {
+    ShareCardJob *job = (ShareCardJob *)data;
+    {
+        TRACE_SCOPE("share_card");
+        // 图片始终是 RGB，不受灰度绘制模式影响
+        cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24,
+                                                              SHARE_CARD_WIDTH, SHARE_CARD_HEIGHT);
+        cairo_t *cr = cairo_create(surface);
+        render_share_card(cr, job->data, SHARE_CARD_WIDTH, SHARE_CARD_HEIGHT);
+        cairo_destroy(cr);
+
+        // 写临时文件后 rename，文档库不会扫描到写了一半的图片
+        mkdir(SHARE_CARD_DIR.c_str(), 0755);
+        std::string tmp_path = job->path + ".tmp";
+        job->ok = cairo_surface_write_to_png(surface, tmp_path.c_str()) == CAIRO_STATUS_SUCCESS
+               && rename(tmp_path.c_str(), job->path.c_str()) == 0;
+        if (!job->ok) unlink(tmp_path.c_str());
+        cairo_surface_destroy(surface);
+    }
+    g_idle_add(share_card_done_idle, job);
+    return NULL;
+}
+
+void share_card_export_async(ShareCardDoneFunc done, gpointer data) {
+    ShareCardJob *job = new ShareCardJob();
+    job->data.view = g_view_data;
+    job->data.day = g_view_daily_ts;
+    job->data.target_minutes = g_daily_target_minutes;
+    job->data.share_url = generate_share_url();
+    job->ok = false;
+    job->done = done;
+    job->user_data = data;
+
+    char name[64];
+    snprintf(name, sizeof(name), "kykky_share_%04d%02d.png",
+             g_view_data.month_year, g_view_data.month_month);
+    job->path = SHARE_CARD_DIR + name;
+
+    pthread_t tid;
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (pthread_create(&tid, &attr, share_card_thread, job) != 0) {
+        job->ok = false;
+        g_idle_add(share_card_done_idle, job);
+    }
+    pthread_attr_destroy(&attr);
+}
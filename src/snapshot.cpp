@@ -0,0 +1,287 @@
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "types.hpp"
+#include "snapshot.hpp"
+#include "trace.hpp"
+
+// —— 文件格式 (本机字节序) ——
+// [SnapshotHeader][SnapshotDay × day_count][SnapshotMonth × month_count]
+// 格式有变化时递增 SNAPSHOT_VERSION，旧文件会被当作无效快照丢弃
+
+static const char SNAPSHOT_MAGIC[8] = {'K', 'Y', 'S', 'T', 'A', 'T', 'S', '\0'};
+static const uint32_t SNAPSHOT_VERSION = 2;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+
+    // 源文件状态
+    int64_t archive_size;
+    int64_t archive_mtime;
+    int64_t log_offset;
+    uint32_t log_check;
+    uint32_t reserved0;
+    char log_name[32];
+
+    int64_t total_seconds;
+    uint32_t day_count;
+    uint32_t month_count;
+    uint32_t checksum;      // 记录区的 FNV-1a
+    uint32_t reserved;
+};
+
+struct SnapshotDay {
+    int64_t day_start;
+    uint32_t seconds;
+    uint16_t buckets[12];   // 与 DayBuckets 相同
+    uint32_t reserved;
+};
+
+struct SnapshotMonth {
+    int32_t year_month;     // 年 * 100 + 月
+    uint32_t seconds;
+};
+
+static_assert(sizeof(SnapshotHeader) == 104, "snapshot header layout changed");
+static_assert(sizeof(SnapshotDay) == 40, "snapshot day layout changed");
+static_assert(sizeof(SnapshotMonth) == 8, "snapshot month layout changed");
+
+static uint32_t fnv1a(const unsigned char *p, size_t n, uint32_t h = 2166136261u) {
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// —— 日志检查点 ——
+// 日志目录在 vfat 上，inode 号每次挂载都会重新分配，不能用来认文件。
+// 取检查点之前最多 LOG_CHECK_BYTES 字节算校验和：文件被替换或截断后重写时对不上
+static const size_t LOG_CHECK_BYTES = 4096;
+
+unsigned int log_checkpoint_sum(const std::string &path, long long offset) {
+    if (offset <= 0) return fnv1a(NULL, 0);
+    FILE *fp = fopen(path.c_str(), "rb");
+    if (!fp) return 0;
+
+    long long start = offset > (long long)LOG_CHECK_BYTES ? offset - (long long)LOG_CHECK_BYTES : 0;
+    unsigned char buf[LOG_CHECK_BYTES];
+    size_t want = (size_t)(offset - start);
+    bool ok = fseeko(fp, start, SEEK_SET) == 0 && fread(buf, 1, want, fp) == want;
+    fclose(fp);
+    // 读不满说明文件比检查点还短，返回与任何校验和都不太可能相等的值
+    return ok ? fnv1a(buf, want) : 0;
+}
+
+// —— 映射与校验 ——
+SnapshotFile::~SnapshotFile() {
+    close();
+}
+
+void SnapshotFile::close() {
+    if (map_) munmap((void *)map_, len_);
+    map_ = NULL;
+    len_ = 0;
+}
+
+// mmap 快照并校验头部与长度。verify_checksum 为 false 时跳过全文校验 (只读单条记录时使用)
+bool SnapshotFile::open(bool verify_checksum) {
+    close();
+    int fd = ::open(SNAPSHOT_FILE.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(SnapshotHeader)) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t len = st.st_size;
+    void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return false;
+
+    const unsigned char *base = (const unsigned char *)map;
+    const SnapshotHeader *hdr = (const SnapshotHeader *)base;
+
+    bool ok = memcmp(hdr->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0
+           && hdr->version == SNAPSHOT_VERSION
+           && hdr->header_size == sizeof(SnapshotHeader)
+           && len == sizeof(SnapshotHeader)
+                     + (size_t)hdr->day_count * sizeof(SnapshotDay)
+                     + (size_t)hdr->month_count * sizeof(SnapshotMonth);
+
+    if (ok && verify_checksum) {
+        ok = fnv1a(base + sizeof(SnapshotHeader), len - sizeof(SnapshotHeader)) == hdr->checksum;
+    }
+    if (!ok) {
+        munmap(map, len);
+        return false;
+    }
+    map_ = map;
+    len_ = len;
+    return true;
+}
+
+static const SnapshotHeader* header_of(const void *map) {
+    return (const SnapshotHeader *)map;
+}
+
+static const SnapshotDay* days_of(const void *map) {
+    return (const SnapshotDay *)(header_of(map) + 1);
+}
+
+bool SnapshotFile::same_source(const StatsSource &src) const {
+    const SnapshotHeader *hdr = header_of(map_);
+    return hdr->archive_size == src.archive_size
+        && hdr->archive_mtime == src.archive_mtime
+        && hdr->log_offset == src.log_offset
+        && hdr->log_check == src.log_check
+        && strncmp(hdr->log_name, src.log_name, sizeof(hdr->log_name)) == 0;
+}
+
+size_t SnapshotFile::day_count() const {
+    return map_ ? header_of(map_)->day_count : 0;
+}
+
+time_t SnapshotFile::day_at(size_t i) const {
+    return (time_t)days_of(map_)[i].day_start;
+}
+
+void SnapshotFile::buckets_at(size_t i, DayBuckets &out) const {
+    memcpy(out.sec, days_of(map_)[i].buckets, sizeof(out.sec));
+}
+
+bool SnapshotFile::find_day(time_t day_start, DayBuckets &out) const {
+    // 记录按日期升序排列，二分查找目标日期
+    const SnapshotDay *days = days_of(map_);
+    size_t lo = 0, hi = day_count();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (days[mid].day_start < (int64_t)day_start) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo >= day_count() || days[lo].day_start != (int64_t)day_start) return false;
+    buckets_at(lo, out);
+    return true;
+}
+
+// —— 读取 ——
+bool load_stats_snapshot(Stats &s, SnapshotFile *keep) {
+    TRACE_SCOPE("load_snapshot");
+
+    // 1. 校验头部、长度与校验和
+    SnapshotFile local;
+    SnapshotFile &snap = keep ? *keep : local;
+    if (!snap.open(true)) return false;
+    const SnapshotHeader *hdr = header_of(snap.map_);
+
+    // 2. 还原聚合数据；分桶留在文件里，按需读取
+    s.total_seconds = hdr->total_seconds;
+    s.source.archive_size = hdr->archive_size;
+    s.source.archive_mtime = hdr->archive_mtime;
+    s.source.log_offset = hdr->log_offset;
+    s.source.log_check = hdr->log_check;
+    memcpy(s.source.log_name, hdr->log_name, sizeof(s.source.log_name));
+    s.source.log_name[sizeof(s.source.log_name) - 1] = '\0';
+
+    const SnapshotDay *days = days_of(snap.map_);
+    for (uint32_t i = 0; i < hdr->day_count; i++) {
+        // 记录按日期升序写入，用 end() 作提示插入是 O(1)
+        s.history_map.emplace_hint(s.history_map.end(), (time_t)days[i].day_start, (long)days[i].seconds);
+    }
+
+    const SnapshotMonth *months = (const SnapshotMonth *)(days + hdr->day_count);
+    for (uint32_t i = 0; i < hdr->month_count; i++) {
+        s.month_map.emplace_hint(s.month_map.end(), months[i].year_month, (long)months[i].seconds);
+    }
+    return true;
+}
+
+bool load_snapshot_day_detail(const StatsSource &expect, time_t day_start, DayBuckets &out) {
+    SnapshotFile snap;
+    if (!snap.open(false)) return false;
+    // 快照必须与当前发布的 Stats 同源，否则分桶可能已经过时
+    return snap.same_source(expect) && snap.find_day(day_start, out);
+}
+
+// —— 写入 ——
+bool save_stats_snapshot(const Stats &s, DetailMap &details, const SnapshotFile *base) {
+    TRACE_SCOPE("save_snapshot");
+    SnapshotHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    hdr.version = SNAPSHOT_VERSION;
+    hdr.header_size = sizeof(SnapshotHeader);
+    hdr.archive_size = s.source.archive_size;
+    hdr.archive_mtime = s.source.archive_mtime;
+    hdr.log_offset = s.source.log_offset;
+    hdr.log_check = s.source.log_check;
+    memcpy(hdr.log_name, s.source.log_name, sizeof(hdr.log_name));
+    hdr.total_seconds = s.total_seconds;
+    hdr.day_count = s.history_map.size();
+    hdr.month_count = s.month_map.size();
+
+    // 1. 写临时文件后 rename，避免写到一半留下损坏的快照。
+    // 保存只在后台读取线程里进行，不会并发；临时文件名仍用 mkstemp 生成，
+    // 这样上次被杀掉时留下的半截文件或其他进程的同名文件都不会被当成本次的输出
+    std::string tmp_path = SNAPSHOT_FILE + ".XXXXXX";
+    int fd = mkstemp(&tmp_path[0]);
+    if (fd < 0) return false;
+    fchmod(fd, 0644);
+    FILE *fp = fdopen(fd, "wb");
+    if (!fp) {
+        ::close(fd);
+        unlink(tmp_path.c_str());
+        return false;
+    }
+
+    // 2. 逐条写出记录区，头部 (含校验和) 最后回填。
+    // 每天的分桶 = 旧快照中的值 + 本次新解析的部分，不在内存中拼出整个文件
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1;
+    uint32_t checksum = fnv1a(NULL, 0);
+    DetailReader reader(details);
+    size_t base_pos = 0, base_count = base ? base->day_count() : 0;
+
+    for (const auto &kv : s.history_map) {
+        if (!ok) break;
+        DayBuckets b;
+        memset(&b, 0, sizeof(b));
+        while (base_pos < base_count && base->day_at(base_pos) < kv.first) base_pos++;
+        if (base_pos < base_count && base->day_at(base_pos) == kv.first) base->buckets_at(base_pos, b);
+        reader.add_to(kv.first, b);
+
+        SnapshotDay d;
+        memset(&d, 0, sizeof(d));
+        d.day_start = kv.first;
+        d.seconds = kv.second;
+        memcpy(d.buckets, b.sec, sizeof(d.buckets));
+        checksum = fnv1a((const unsigned char *)&d, sizeof(d), checksum);
+        ok = fwrite(&d, sizeof(d), 1, fp) == 1;
+    }
+    for (const auto &kv : s.month_map) {
+        if (!ok) break;
+        SnapshotMonth m;
+        m.year_month = kv.first;
+        m.seconds = kv.second;
+        checksum = fnv1a((const unsigned char *)&m, sizeof(m), checksum);
+        ok = fwrite(&m, sizeof(m), 1, fp) == 1;
+    }
+
+    hdr.checksum = checksum;
+    ok = ok && fseek(fp, 0, SEEK_SET) == 0 && fwrite(&hdr, sizeof(hdr), 1, fp) == 1;
+    ok = (fclose(fp) == 0) && ok;
+    if (!ok || rename(tmp_path.c_str(), SNAPSHOT_FILE.c_str()) != 0) {
+        unlink(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,134 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "trace.hpp"
+
+struct TraceEvent {
+    const char *name;
+    long long ts_us;    // 相对 trace_init 的开始时间
+    long long dur_us;   // -1 表示瞬时事件
+    long tid;
+};
+
+static bool s_enabled = false;
+static std::string s_path;
+static long long s_origin_us = 0;
+static std::mutex s_mutex;
+static std::vector<TraceEvent> s_events;
+
+static long long now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static long current_tid() {
+    return (long)syscall(SYS_gettid);
+}
+
+static void record(const char *name, long long start_us, long long dur_us) {
+    TraceEvent e;
+    e.name = name;
+    e.ts_us = start_us - s_origin_us;
+    e.dur_us = dur_us;
+    e.tid = current_tid();
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_events.push_back(e);
+}
+
+void trace_init() {
+    const char *env = getenv("KYKKY_TRACE");
+    if (!env || !env[0] || strcmp(env, "0") == 0) return;
+
+    s_path = (strcmp(env, "1") == 0) ? "/tmp/kykky_trace.json" : env;
+    s_origin_us = now_us();
+    s_events.reserve(64);
+    s_enabled = true;
+}
+
+bool trace_enabled() {
+    return s_enabled;
+}
+
+TraceSpan::TraceSpan(const char *name) : name_(name), start_us_(0) {
+    if (s_enabled) start_us_ = now_us();
+}
+
+TraceSpan::~TraceSpan() {
+    if (s_enabled) record(name_, start_us_, now_us() - start_us_);
+}
+
+void trace_instant(const char *name) {
+    if (s_enabled) record(name, now_us(), -1);
+}
+
+void trace_flush() {
+    if (!s_enabled) return;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    FILE *fp = fopen(s_path.c_str(), "w");
+    if (!fp) return;
+
+    long pid = (long)getpid();
+    fprintf(fp, "{\"traceEvents\":[\n");
+    for (size_t i = 0; i < s_events.size(); i++) {
+        const TraceEvent &e = s_events[i];
+        if (e.dur_us >= 0) {
+            fprintf(fp, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":%ld,\"tid\":%ld}",
+                    e.name, e.ts_us, e.dur_us, pid, e.tid);
+        } else {
+            fprintf(fp, "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"p\",\"ts\":%lld,\"pid\":%ld,\"tid\":%ld}",
+                    e.name, e.ts_us, pid, e.tid);
+        }
+        fprintf(fp, "%s\n", (i + 1 < s_events.size()) ? "," : "");
+    }
+    fprintf(fp, "],\"displayTimeUnit\":\"ms\"}\n");
+    fclose(fp);
+}
+
+void trace_startup_done() {
+    // 只汇总第一次启动，之后的增量刷新 (再次启动转交) 只更新 trace 文件
+    static bool reported = false;
+    if (!s_enabled) return;
+    if (reported) {
+        trace_flush();
+        return;
+    }
+    reported = true;
+    long long total_us = now_us() - s_origin_us;
+
+    // 同名阶段累加，按第一次出现的顺序输出
+    std::string summary;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        std::vector<const char *> names;
+        std::vector<long long> sums;
+        for (const TraceEvent &e : s_events) {
+            if (e.dur_us < 0) continue;
+            size_t k = 0;
+            while (k < names.size() && strcmp(names[k], e.name) != 0) k++;
+            if (k == names.size()) {
+                names.push_back(e.name);
+                sums.push_back(0);
+            }
+            sums[k] += e.dur_us;
+        }
+
+        char buf[96];
+        for (size_t k = 0; k < names.size(); k++) {
+            snprintf(buf, sizeof(buf), "%s %s %.1f", k ? "," : "", names[k], sums[k] / 1000.0);
+            summary += buf;
+        }
+    }
+
+    fprintf(stderr, "[kykky] startup %.1f ms:%s (ms)\n", total_us / 1000.0, summary.c_str());
+    trace_flush();
+}
@@ -38,6 +38,18 @@ void get_week_start(time_t &week_start) {
     week_start = today_start - offset * 24 * 3600;
 }
 
+// 日期加减 n 天，结果为目标日 0 点 (按日历计算，不受夏令时影响)
+time_t add_days(time_t day_start, int n) {
+    struct tm tmv;
+    localtime_r(&day_start, &tmv);
+    tmv.tm_mday += n;
+    tmv.tm_hour = 0;
+    tmv.tm_min = 0;
+    tmv.tm_sec = 0;
+    tmv.tm_isdst = -1;
+    return mktime(&tmv);
+}
+
 void get_month_start(time_t &month_start, int &year, int &month) {
     time_t now = time(NULL);
     struct tm tmv;
@@ -77,6 +89,8 @@ void save_target_config() {
     if (fp) {
         fprintf(fp, "daily_target_minutes=%d\n", g_daily_target_minutes);
         fprintf(fp, "share_domain=%s\n", g_share_domain.c_str()); 
+        fprintf(fp, "detail_cache_kib=%d\n", g_detail_cache_kib);
+        fprintf(fp, "gray_render=%d\n", g_gray_render ? 1 : 0);
         fclose(fp);
     }
 }
@@ -85,6 +99,8 @@ void load_target_config() {
     // 首先设置默认值
     g_daily_target_minutes = DEFAULT_TARGET_MINUTES;
     g_share_domain = "reading.tqhyg.net";
+    g_detail_cache_kib = DEFAULT_DETAIL_CACHE_KIB;
+    g_gray_render = false;
     
     FILE *fp = fopen(CONFIG_FILE.c_str(), "r");
     if (!fp) {
@@ -97,6 +113,8 @@ void load_target_config() {
     char line[512];
     bool has_target = false;
     bool has_domain = false;
+    bool has_cache = false;
+    bool has_gray = false;
     
     while (fgets(line, sizeof(line), fp)) {
         // 移除换行符
@@ -121,12 +139,25 @@ void load_target_config() {
             }
             has_domain = true;
         }
+        // 解析分桶详情缓存预算 (KiB，0 表示不限制)
+        else if (strncmp(line, "detail_cache_kib=", 17) == 0) {
+            int value = atoi(line + 17);
+            if (value >= 0) {
+                g_detail_cache_kib = value;
+            }
+            has_cache = true;
+        }
+        // 图表灰度绘制模式 (0=RGB，1=8 位灰度)
+        else if (strncmp(line, "gray_render=", 12) == 0) {
+            g_gray_render = atoi(line + 12) != 0;
+            has_gray = true;
+        }
     }
     
     fclose(fp);
     
     // 如果配置项缺失，补全配置
-    if (!has_target || !has_domain) {
+    if (!has_target || !has_domain || !has_cache || !has_gray) {
         save_target_config();
     }
 }
@@ -160,23 +191,36 @@ void refresh_all_status_labels() {
 
 }
 
-static const std::string base64_chars =
+static const char base64_chars[] =
 "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
 "abcdefghijklmnopqrstuvwxyz"
 "0123456789+/";
 
-std::string base64_encode(const std::string& in) {
+static const char base64url_chars[] =
+"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+"abcdefghijklmnopqrstuvwxyz"
+"0123456789-_";
+
+static std::string base64_encode_with(const std::string& in, const char *chars, bool pad) {
     std::string out;
     int val = 0, valb = -6;
     for (unsigned char c : in) {
         val = (val << 8) + c;
         valb += 8;
         while (valb >= 0) {
-            out.push_back(base64_chars[(val >> valb) & 0x3F]);
+            out.push_back(chars[(val >> valb) & 0x3F]);
             valb -= 6;
         }
     }
-    if (valb > -6) out.push_back(base64_chars[((val << 8) >> (valb + 8)) & 0x3F]);
-    while (out.size() % 4) out.push_back('=');
+    if (valb > -6) out.push_back(chars[((val << 8) >> (valb + 8)) & 0x3F]);
+    while (pad && out.size() % 4) out.push_back('=');
     return out;
 }
+
+std::string base64_encode(const std::string& in) {
+    return base64_encode_with(in, base64_chars, true);
+}
+
+std::string base64url_encode(const std::string& in) {
+    return base64_encode_with(in, base64url_chars, false);
+}
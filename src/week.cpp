@@ -1,20 +1,71 @@
+#include <map>
+#include <array>
+
 #include "types.hpp"
 #include "utils.hpp"
+#include "dataprocess.hpp"
 #include "week.hpp"
+#include "render.hpp"
+#include "navsched.hpp"
+
+// —— 周数据预取缓存 ——
+// 翻周时直接从缓存取 7 天数据，相邻周在空闲时提前算好
+typedef std::array<long, 7> WeekDays;
+static std::map<time_t, WeekDays> s_week_cache;
+static unsigned int s_week_cache_generation = 0;
+static guint s_prefetch_source = 0;
+
+static const WeekDays& load_week(time_t week_start) {
+    // 数据重读后缓存作废
+    StatsRef stats = stats_current();
+    if (s_week_cache_generation != stats->generation) {
+        s_week_cache.clear();
+        s_week_cache_generation = stats->generation;
+    }
 
-// —— 本周分布绘图（柱状图） ——
-gboolean draw_week_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
-    cairo_t *cr = gdk_cairo_create(widget->window);
+    auto it = s_week_cache.find(week_start);
+    if (it == s_week_cache.end()) {
+        WeekDays days;
+        compute_week_days(*stats, week_start, days.data());
+        it = s_week_cache.emplace(week_start, days).first;
+    }
+    return it->second;
+}
 
-    cairo_set_source_rgb(cr, 1, 1, 1);
-    cairo_paint(cr);
+static gboolean prefetch_neighbour_weeks(gpointer data) {
+    s_prefetch_source = 0;
+    load_week(add_days(g_view_week_start, -7));
+    load_week(add_days(g_view_week_start, 7));
+
+    // 只保留当前周附近的数据，避免缓存无限增长
+    time_t lo = add_days(g_view_week_start, -14);
+    time_t hi = add_days(g_view_week_start, 14);
+    for (auto it = s_week_cache.begin(); it != s_week_cache.end(); ) {
+        if (it->first < lo || it->first > hi) it = s_week_cache.erase(it);
+        else ++it;
+    }
+    return FALSE;
+}
 
-    int w = widget->allocation.width;
-    int h = widget->allocation.height;
+static void schedule_week_prefetch() {
+    if (s_prefetch_source == 0) {
+        s_prefetch_source = g_idle_add(prefetch_neighbour_weeks, NULL);
+    }
+}
+
+// 将缓存中的周数据写入当前视图
+static void apply_view_week(time_t week_start) {
+    set_week_view_data(g_view_data, week_start, load_week(week_start).data());
+}
+
+// —— 本周分布绘图（柱状图） ——
+void render_week_dist(cairo_t *cr, const ViewData &v, int w, int h) {
+    set_gray(cr, 1);
+    cairo_paint(cr);
 
     int left = 60, right = 20, top = 60, bottom = 60;
 
-    cairo_set_source_rgb(cr, 0, 0, 0);
+    set_gray(cr, 0);
     cairo_set_line_width(cr, 2);
 
     cairo_move_to(cr, left, top);
@@ -24,7 +75,7 @@ gboolean draw_week_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data)
 
     long maxv = 7200;
     for (int i = 0; i < 7; i++)
-        if (g_stats.week_days[i] > maxv) maxv = g_stats.week_days[i];
+        if (v.view_week_days[i] > maxv) maxv = v.view_week_days[i];
 
     int chart_w = w - left - right;
     int chart_h = h - top - bottom - 100;
@@ -34,16 +85,20 @@ gboolean draw_week_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data)
 
     const char *names[7] = {"周一","周二","周三","周四","周五","周六","周日"};
 
+    // 所有柱子合成一条路径一次填充，文字随后绘制
+    for (int i = 0; i < 7; i++) {
+        double x = left + bar_space * i + (bar_space - bar_w)/2;
+        double bh = (v.view_week_days[i] / (double)maxv) * chart_h;
+        cairo_rectangle(cr, x, h - bottom - bh, bar_w, bh);
+    }
+    cairo_fill(cr);
+
     for (int i = 0; i < 7; i++) {
         double x = left + bar_space * i + (bar_space - bar_w)/2;
-        double val = g_stats.week_days[i];
+        double val = v.view_week_days[i];
         double bh = (val / (double)maxv) * chart_h;
         double y = h - bottom - bh;
 
-        cairo_set_source_rgb(cr, 0, 0, 0);
-        cairo_rectangle(cr, x, y, bar_w, bh);
-        cairo_fill(cr);
-
         long mins = val / 60;
         if (mins > 0) {
             char buf[32];
@@ -60,35 +115,119 @@ gboolean draw_week_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data)
 
     int best = 0;
     for (int i = 1; i < 7; i++)
-        if (g_stats.week_days[i] > g_stats.week_days[best]) best = i;
+        if (v.view_week_days[i] > v.view_week_days[best]) best = i;
+
+    bool is_current_week = v.view_week_is_current;
 
     char comment[128];
     snprintf(comment, sizeof(comment),
-             "本周你读得最多的一天是 %s", names[best]);
+             "%s你读得最多的一天是 %s", is_current_week ? "本周" : "这周", names[best]);
 
     cairo_set_font_size(cr, 40);
     cairo_move_to(cr, left + 20, top + 40);
     cairo_show_text(cr, comment);
 
     char week_total_str[64];
-    format_hms(g_stats.week_seconds, week_total_str, sizeof(week_total_str));
+    format_hms(v.view_week_seconds, week_total_str, sizeof(week_total_str));
 
     char week_title[128];
-    snprintf(week_title, sizeof(week_title), "本周总时长: %s", week_total_str);
+    snprintf(week_title, sizeof(week_title), "%s总时长: %s",
+             is_current_week ? "本周" : "该周", week_total_str);
 
-    cairo_set_source_rgb(cr, 0, 0, 0);
+    set_gray(cr, 0);
     cairo_set_font_size(cr, 50);
     cairo_move_to(cr, left, top - 10);
     cairo_show_text(cr, week_title);
+}
+
+static ChartCache s_week_chart;
 
-    cairo_destroy(cr);
+gboolean draw_week_dist(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
+    // 跨过周一 0 点后 "本周" 变成 "这周"，数据不变也要让缓存的图表失效
+    set_week_view_data(g_view_data, g_view_data.view_week_start, g_view_data.view_week_days);
+    chart_cache_paint(s_week_chart, widget, event, g_view_data.week_version, render_week_dist);
     return FALSE;
 }
 
+void update_week_title(WeekViewWidgets *wv) {
+    time_t week_end = add_days(g_view_week_start, 6);
+    struct tm tm_s, tm_e;
+    localtime_r(&g_view_week_start, &tm_s);
+    localtime_r(&week_end, &tm_e);
+
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%04d年%02d月%02d日 - %02d月%02d日",
+             tm_s.tm_year + 1900, tm_s.tm_mon + 1, tm_s.tm_mday,
+             tm_e.tm_mon + 1, tm_e.tm_mday);
+    gtk_label_set_text(GTK_LABEL(wv->label_title), buf);
+}
+
+static WeekViewWidgets *s_week_widgets = NULL;
+
+void week_view_data_changed() {
+    if (!s_week_widgets) return;
+    update_week_title(s_week_widgets);
+    gtk_widget_queue_draw(s_week_widgets->drawing_area);
+}
+
+static NavScheduler s_week_nav;
+
+static void commit_week_step(gpointer data) {
+    WeekViewWidgets *wv = (WeekViewWidgets*)data;
+    // 只查 Map，不重读日志
+    apply_view_week(g_view_week_start);
+    gtk_widget_queue_draw(wv->drawing_area);
+    schedule_week_prefetch();
+}
+
+static void week_step(WeekViewWidgets *wv, int weeks) {
+    // 标题立即更新，数据和重绘等点击停下后只做一次
+    g_view_week_start = add_days(g_view_week_start, weeks * 7);
+    update_week_title(wv);
+    nav_request(s_week_nav, commit_week_step, wv);
+}
+
+void week_prev(GtkButton *b, gpointer data) {
+    week_step((WeekViewWidgets*)data, -1);
+}
+
+void week_next(GtkButton *b, gpointer data) {
+    week_step((WeekViewWidgets*)data, 1);
+}
+
 GtkWidget* create_week_page() {
+    GtkWidget *vbox = gtk_vbox_new(FALSE, 5);
+
+    WeekViewWidgets *wv = (WeekViewWidgets*)g_malloc0(sizeof(WeekViewWidgets));
+    s_week_widgets = wv;
+
+    GtkWidget *hbox = gtk_hbox_new(FALSE, 5);
+    GtkWidget *btn_prev = gtk_button_new_with_label("<-上一周");
+    GtkWidget *btn_next = gtk_button_new_with_label("下一周->");
+    GtkWidget *lbl = gtk_label_new("");
+
+    wv->label_title = lbl;
+
+    gtk_box_pack_start(GTK_BOX(hbox), btn_prev, FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), lbl, TRUE, TRUE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), btn_next, FALSE, FALSE, 5);
+
     GtkWidget *da = gtk_drawing_area_new();
+    wv->drawing_area = da;
     gtk_widget_set_size_request(da, 800, 500);
     g_signal_connect(G_OBJECT(da), "expose-event",
                      G_CALLBACK(draw_week_dist), NULL);
-    return da;
-}
\ No newline at end of file
+
+    g_signal_connect(G_OBJECT(btn_prev), "clicked",
+                     G_CALLBACK(week_prev), wv);
+    g_signal_connect(G_OBJECT(btn_next), "clicked",
+                     G_CALLBACK(week_next), wv);
+
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), da, TRUE, TRUE, 5);
+
+    update_week_title(wv);
+    schedule_week_prefetch();
+
+    return vbox;
+}
@@ -0,0 +1,260 @@
+#include <string.h>
+#include <vector>
+
+#include "types.hpp"
+#include "utils.hpp"
+#include "daily.hpp"
+#include "month.hpp"
+#include "dataprocess.hpp"
+#include "year.hpp"
+#include "render.hpp"
+#include "navsched.hpp"
+
+// 年度热力图布局：cols 列 (周) × 7 行 (周一到周日)
+// 一般为 53 列；闰年且 1 月 1 日是周日时 (如 2012、2040) 最后一天落在第 54 列
+struct YearLayout {
+    double left;
+    double top;
+    double cell;       // 单元格边长
+    int first_row;     // 1月1日所在行 (0=Mon)
+    int days;          // 全年天数
+    int cols;          // 列数，绘制与点击共用
+};
+
+static void compute_year_layout(int w, int year, YearLayout &lay) {
+    int left = 90, right = 20, top = 80;
+
+    struct tm tmv;
+    memset(&tmv, 0, sizeof(tmv));
+    tmv.tm_year = year - 1900;
+    tmv.tm_mon = 0;
+    tmv.tm_mday = 1;
+    tmv.tm_isdst = -1;
+    mktime(&tmv);
+    lay.first_row = (tmv.tm_wday + 6) % 7;
+    lay.days = (days_in_month(year, 2) == 29) ? 366 : 365;
+    lay.cols = (lay.first_row + lay.days - 1) / 7 + 1;
+
+    lay.cell = (double)(w - left - right) / lay.cols;
+    lay.left = left;
+    lay.top = top;
+}
+
+static time_t year_start_ts(int year) {
+    struct tm tmv;
+    memset(&tmv, 0, sizeof(tmv));
+    tmv.tm_year = year - 1900;
+    tmv.tm_mday = 1;
+    tmv.tm_isdst = -1;
+    return mktime(&tmv);
+}
+
+// —— 年度热力图绘制 ——
+// 只遍历 history_map 中落在该年的记录，一次完成
+void render_year_view(cairo_t *cr, const Stats &stats, int year, int w, int h) {
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    cairo_paint(cr);
+
+    YearLayout lay;
+    compute_year_layout(w, year, lay);
+
+    time_t y_start = year_start_ts(year);
+    time_t y_end = year_start_ts(year + 1);
+
+    auto first = stats.history_map.lower_bound(y_start);
+    auto last = stats.history_map.lower_bound(y_end);
+
+    // 1. 统计全年数据，确定灰度基准 (与月视图一致)
+    long basic_sec = g_daily_target_minutes * 60;
+    long max_seconds = g_daily_target_minutes * 60;
+    long year_total = 0;
+    int read_days = 0;
+    for (auto it = first; it != last; ++it) {
+        if (it->second > max_seconds) max_seconds = it->second;
+        year_total += it->second;
+        if (it->second > 0) read_days++;
+    }
+
+    // 2. 有阅读记录的格子按灰度填充，同一灰度一次填完
+    std::vector<GrayRect> fills;
+    for (auto it = first; it != last; ++it) {
+        long sec = it->second;
+        if (sec <= basic_sec) continue;
+
+        struct tm tmv;
+        localtime_r(&it->first, &tmv);
+        int off = lay.first_row + tmv.tm_yday;
+
+        GrayRect r;
+        r.gray = get_gray_level_16((double)sec / (double)max_seconds);
+        r.x = lay.left + (off / 7) * lay.cell;
+        r.y = lay.top + (off % 7) * lay.cell;
+        r.w = lay.cell;
+        r.h = lay.cell;
+        fills.push_back(r);
+    }
+    fill_rects_by_gray(cr, fills);
+
+    // 3. 全年格子边框，合成一条路径一次描边
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_set_line_width(cr, 1);
+    for (int d = 0; d < lay.days; d++) {
+        int off = lay.first_row + d;
+        cairo_rectangle(cr, lay.left + (off / 7) * lay.cell,
+                        lay.top + (off % 7) * lay.cell, lay.cell, lay.cell);
+    }
+    cairo_stroke(cr);
+
+    // 4. 星期标签 (只标一、三、五、日，避免拥挤)
+    const char *weeknames[7] = {"Mon", "", "Wed", "", "Fri", "", "Sun"};
+    cairo_set_font_size(cr, 18);
+    for (int r = 0; r < 7; r++) {
+        if (!weeknames[r][0]) continue;
+        cairo_move_to(cr, 20, lay.top + r * lay.cell + lay.cell - 3);
+        cairo_show_text(cr, weeknames[r]);
+    }
+
+    // 5. 月份标签：标在每月 1 日所在的列上方
+    cairo_set_font_size(cr, 22);
+    for (int m = 1; m <= 12; m++) {
+        struct tm tmv;
+        memset(&tmv, 0, sizeof(tmv));
+        tmv.tm_year = year - 1900;
+        tmv.tm_mon = m - 1;
+        tmv.tm_mday = 1;
+        tmv.tm_isdst = -1;
+        mktime(&tmv);
+        int col = (lay.first_row + tmv.tm_yday) / 7;
+
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%d月", m);
+        cairo_move_to(cr, lay.left + col * lay.cell, lay.top - 12);
+        cairo_show_text(cr, buf);
+    }
+
+    // 6. 全年汇总
+    char total_str[64];
+    format_hms(year_total, total_str, sizeof(total_str));
+
+    char buf[128];
+    double text_y = lay.top + 7 * lay.cell + 80;
+    snprintf(buf, sizeof(buf), "全年总时长: %s", total_str);
+    cairo_set_font_size(cr, 40);
+    cairo_move_to(cr, lay.left, text_y);
+    cairo_show_text(cr, buf);
+
+    snprintf(buf, sizeof(buf), "全年阅读 %d 天", read_days);
+    cairo_move_to(cr, lay.left, text_y + 60);
+    cairo_show_text(cr, buf);
+}
+
+gboolean draw_year_view(GtkWidget *widget, GdkEventExpose *event, gpointer data) {
+    cairo_t *cr = gdk_cairo_create(widget->window);
+    StatsRef stats = stats_current();
+    render_year_view(cr, *stats, g_view_heatmap_year,
+                     widget->allocation.width, widget->allocation.height);
+    cairo_destroy(cr);
+    return FALSE;
+}
+
+void update_year_title(YearViewWidgets *yv) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%04d年", g_view_heatmap_year);
+    gtk_label_set_text(GTK_LABEL(yv->label_title), buf);
+}
+
+static YearViewWidgets *s_year_widgets = NULL;
+
+void year_view_data_changed() {
+    if (s_year_widgets) gtk_widget_queue_draw(s_year_widgets->drawing_area);
+}
+
+static NavScheduler s_year_nav;
+
+static void commit_year_step(gpointer data) {
+    YearViewWidgets *yv = (YearViewWidgets*)data;
+    gtk_widget_queue_draw(yv->drawing_area);
+}
+
+// 标题立即更新，重绘等点击停下后只做一次
+static void year_step(YearViewWidgets *yv, int delta) {
+    g_view_heatmap_year += delta;
+    update_year_title(yv);
+    nav_request(s_year_nav, commit_year_step, yv);
+}
+
+void year_prev(GtkButton *b, gpointer data) {
+    year_step((YearViewWidgets*)data, -1);
+}
+
+void year_next(GtkButton *b, gpointer data) {
+    year_step((YearViewWidgets*)data, 1);
+}
+
+gboolean on_year_click(GtkWidget *widget, GdkEventButton *event, gpointer data) {
+    if (event->type != GDK_BUTTON_PRESS) return FALSE;
+    // 翻年尚未重绘时，屏幕上的格子与当前年份对不上
+    if (s_year_nav.source) return FALSE;
+
+    int w = widget->allocation.width;
+    int year = g_view_heatmap_year;
+
+    YearLayout lay;
+    compute_year_layout(w, year, lay);
+
+    if (event->x < lay.left || event->y < lay.top) return FALSE;
+
+    int col = (int)((event->x - lay.left) / lay.cell);
+    int row = (int)((event->y - lay.top) / lay.cell);
+    if (col < 0 || col >= lay.cols || row < 0 || row >= 7) return FALSE;
+
+    // 格子序号换算成年内第几天
+    int yday = col * 7 + row - lay.first_row;
+    if (yday < 0 || yday >= lay.days) return FALSE;
+
+    show_daily_view(add_days(year_start_ts(year), yday));
+    return TRUE;
+}
+
+GtkWidget* create_year_page() {
+    GtkWidget *vbox = gtk_vbox_new(FALSE, 5);
+
+    YearViewWidgets *yv = (YearViewWidgets*)g_malloc0(sizeof(YearViewWidgets));
+    s_year_widgets = yv;
+
+    GtkWidget *hbox = gtk_hbox_new(FALSE, 5);
+    GtkWidget *btn_prev = gtk_button_new_with_label("<-上一年");
+    GtkWidget *btn_next = gtk_button_new_with_label("下一年->");
+    GtkWidget *lbl = gtk_label_new("");
+
+    yv->label_title = lbl;
+
+    gtk_box_pack_start(GTK_BOX(hbox), btn_prev, FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), lbl, TRUE, TRUE, 5);
+    gtk_box_pack_start(GTK_BOX(hbox), btn_next, FALSE, FALSE, 5);
+
+    GtkWidget *da = gtk_drawing_area_new();
+
+    // 允许画布接收点击事件，点击格子跳转日视图
+    gtk_widget_add_events(da, GDK_BUTTON_PRESS_MASK);
+    g_signal_connect(G_OBJECT(da), "button-press-event",
+                     G_CALLBACK(on_year_click), NULL);
+
+    yv->drawing_area = da;
+    gtk_widget_set_size_request(da, 800, 500);
+
+    g_signal_connect(G_OBJECT(da), "expose-event",
+                     G_CALLBACK(draw_year_view), NULL);
+
+    g_signal_connect(G_OBJECT(btn_prev), "clicked",
+                     G_CALLBACK(year_prev), yv);
+    g_signal_connect(G_OBJECT(btn_next), "clicked",
+                     G_CALLBACK(year_next), yv);
+
+    gtk_box_pack_start(GTK_BOX(vbox), hbox, FALSE, FALSE, 5);
+    gtk_box_pack_start(GTK_BOX(vbox), da, TRUE, TRUE, 5);
+
+    update_year_title(yv);
+
+    return vbox;
+}
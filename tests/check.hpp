@@ -0,0 +1,31 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdio>
+
+// —— 测试断言 ——
+// 各测试程序共用：失败时打印位置和说明并计数，不中断后续检查，
+// main 最后用 check_report() 的返回值作为退出码
+
+static int s_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__); \
+        fputc('\n', stderr); \
+        s_failures++; \
+    } \
+} while (0)
+
+// 汇总结果：全部通过时打印 OK 并返回 0，否则返回 1
+static int check_report() {
+    if (s_failures) {
+        fprintf(stderr, "%d check(s) failed\n", s_failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
+
+#endif
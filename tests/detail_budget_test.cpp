@@ -0,0 +1,151 @@
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "types.hpp"
+#include "utils.hpp"
+#include "dataprocess.hpp"
+#include "detailcache.hpp"
+#include "check.hpp"
+
+// —— 分桶详情内存预算 ——
+// 合成十年的阅读记录，检查三种读取方式 (全量重建、增量、快照失效后重建) 下：
+//   1. 构建期间堆内存峰值 - 起始值 ≤ 新 Stats 的每日/每月 Map + 预算相关的上限
+//   2. 构建完成后分桶缓存不超过预算
+//   3. 每一天的分桶之和等于当天总数 (溢出到临时文件的部分合并正确)
+
+// —— 堆内存计数 ——
+// 每块前面放 16 字节记录大小，统计当前占用与峰值
+static std::atomic<size_t> s_heap_now(0);
+static std::atomic<size_t> s_heap_peak(0);
+
+static void* counted_alloc(size_t n) {
+    void *p = malloc(n + 16);
+    if (!p) throw std::bad_alloc();
+    *(size_t *)p = n;
+    size_t now = (s_heap_now += n);
+    size_t peak = s_heap_peak;
+    while (now > peak && !s_heap_peak.compare_exchange_weak(peak, now)) {}
+    return (char *)p + 16;
+}
+
+static void counted_free(void *p) {
+    if (!p) return;
+    char *base = (char *)p - 16;
+    s_heap_now -= *(size_t *)base;
+    free(base);
+}
+
+void* operator new(size_t n) { return counted_alloc(n); }
+void* operator new[](size_t n) { return counted_alloc(n); }
+void operator delete(void *p) noexcept { counted_free(p); }
+void operator delete[](void *p) noexcept { counted_free(p); }
+void operator delete(void *p, size_t) noexcept { counted_free(p); }
+void operator delete[](void *p, size_t) noexcept { counted_free(p); }
+
+// —— 测试数据 ——
+static const int HISTORY_DAYS = 3650;
+static const int BUDGET_KIB = 64;
+// 解析缓冲、字符串、文件句柄等与天数无关的开销
+static const size_t FIXED_SLACK = 64 * 1024;
+
+static void append_reading(FILE *fp, time_t end, long seconds) {
+    fprintf(fp, "0,%ld,0,0,0,com.lab126.booklet.reader.activeDuration,%ld\n", (long)end, seconds * 1000);
+}
+
+// 十年前到上个月，每天 0-3 次阅读，写成一个旧的月度日志，由 preprocess_data 并入归档
+static void write_history(time_t today) {
+    std::string path = LOG_DIR + LOG_PREFIX + "0101";
+    FILE *fp = fopen(path.c_str(), "w");
+    time_t first = add_days(today, -HISTORY_DAYS);
+    for (int d = 0; d < HISTORY_DAYS - 40; d++) {
+        time_t day = add_days(first, d);
+        for (int k = 0; k < d % 4; k++) {
+            append_reading(fp, day + 3600 * (3 + k * 5) + (d * 37) % 3000, 600 + (d * 13 + k * 7) % 5000);
+        }
+    }
+    fclose(fp);
+}
+
+// 当月日志追加几条，走增量路径
+static void append_current_log(time_t today) {
+    time_t now = time(NULL);
+    struct tm tmv;
+    localtime_r(&now, &tmv);
+    char name[32];
+    snprintf(name, sizeof(name), "%s%02d%02d", LOG_PREFIX, (tmv.tm_year + 1900) % 100, tmv.tm_mon + 1);
+    FILE *fp = fopen((LOG_DIR + name).c_str(), "a");
+    append_reading(fp, today + 60, 30);
+    fclose(fp);
+}
+
+static size_t stats_bytes(const Stats &s) {
+    return s.history_map.size() * map_node_bytes<decltype(s.history_map)>()
+         + s.month_map.size() * map_node_bytes<decltype(s.month_map)>();
+}
+
+static void run_build(const char *phase) {
+    size_t start = s_heap_now;
+    s_heap_peak = start;
+
+    StatsRef s = build_stats();
+    size_t peak = s_heap_peak - start;
+    CHECK(s, "%s: build_stats returned no stats", phase);
+    if (!s) return;
+    stats_publish(s);
+
+    size_t budget = detail_cache_budget();
+    size_t limit = stats_bytes(*s) + 2 * budget + FIXED_SLACK;
+    printf("%-12s days=%zu peak=%zu B limit=%zu B cache=%zu B budget=%zu B\n",
+           phase, s->history_map.size(), peak, limit, detail_cache_bytes(), budget);
+
+    CHECK(s->history_map.size() > 2000, "%s: only %zu days parsed", phase, s->history_map.size());
+    CHECK(peak <= limit, "%s: peak %zu B exceeds %zu B", phase, peak, limit);
+    CHECK(detail_cache_bytes() <= budget, "%s: cache %zu B exceeds budget %zu B",
+          phase, detail_cache_bytes(), budget);
+
+    // 抽查分桶：按步长遍历，覆盖常驻窗口和溢出部分
+    int checked = 0;
+    int step = 0;
+    for (const auto &kv : s->history_map) {
+        if (step++ % 37 != 0) continue;
+        long b[12];
+        long sum = 0;
+        CHECK(detail_cache_get(kv.first, b), "%s: no buckets for day %ld", phase, (long)kv.first);
+        for (int i = 0; i < 12; i++) sum += b[i];
+        CHECK(sum == kv.second, "%s: day %ld buckets %ld != total %ld", phase, (long)kv.first, sum, kv.second);
+        checked++;
+    }
+    CHECK(detail_cache_bytes() <= budget, "%s: cache %zu B exceeds budget after lookups", phase,
+          detail_cache_bytes());
+    printf("%-12s checked %d days\n", phase, checked);
+}
+
+int main() {
+    mkdir(BASE_DIR.c_str(), 0755);
+    mkdir(LOG_DIR.c_str(), 0755);
+    mkdir((BASE_DIR + "etc").c_str(), 0755);
+
+    time_t today, tomorrow;
+    get_today_bounds(today, tomorrow);
+    write_history(today);
+    preprocess_data();
+
+    g_detail_cache_kib = BUDGET_KIB;
+    run_build("full");
+
+    append_current_log(today);
+    run_build("incremental");
+
+    unlink(SNAPSHOT_FILE.c_str());
+    run_build("rebuild");
+
+    std::string cmd = "rm -rf '" + BASE_DIR + "'";
+    if (system(cmd.c_str()) != 0) fprintf(stderr, "could not remove %s\n", BASE_DIR.c_str());
+
+    return check_report();
+}
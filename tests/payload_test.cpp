@@ -0,0 +1,129 @@
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "payload.hpp"
+#include "check.hpp"
+
+// —— 紧凑编码 ——
+// 固定样例逐字节对照 payload.hpp 里的规范 (位图位序、多字节变长整数)，
+// 再把各类型编码后解码回来，确认服务端按规范能还原出同样的数据
+
+static std::string bytes(const std::vector<int> &v) {
+    std::string s;
+    for (int b : v) s.push_back((char)b);
+    return s;
+}
+
+static std::string hex(const std::string &s) {
+    std::string out;
+    char buf[4];
+    for (unsigned char c : s) {
+        snprintf(buf, sizeof(buf), "%02x ", c);
+        out += buf;
+    }
+    return out;
+}
+
+static std::vector<long> minutes_of(const std::vector<long> &seconds) {
+    std::vector<long> out;
+    for (long sec : seconds) out.push_back(sec > 0 ? (sec + 59) / 60 : 0);
+    return out;
+}
+
+// 年 2024 = 0x7E8 -> e8 0f；180 分钟 -> b4 01
+static void test_month_bytes() {
+    std::vector<long> days = {0, 60, 3 * 3600, 0, 0, 0, 0, 0, 61};
+    long buckets[12] = {0};
+    buckets[0] = 1;
+    buckets[11] = 300 * 60;
+
+    std::string got = payload_month_share(2024, 5, 30, days, buckets);
+    std::string want = bytes({
+        0x11,                   // 类型 1，版本 1
+        0xe8, 0x0f, 0x05, 0x1e, // 年、月、目标
+        0x09, 0x06, 0x01,       // 9 天；第 1、2 天在第一字节的 bit1、bit2，第 8 天在第二字节的 bit0
+        0x01, 0xb4, 0x01, 0x02, // 1、180、2 (61 秒向上取整)
+        0x0c, 0x01, 0x08,       // 12 段；第 0 段 bit0，第 11 段在第二字节的 bit3
+        0x01, 0xac, 0x02        // 1、300
+    });
+    CHECK(got == want, "month bytes\n  got  %s\n  want %s", hex(got).c_str(), hex(want).c_str());
+}
+
+static void test_fast_sync_bytes() {
+    std::string got = payload_fast_sync("ab", 300, 1000000);
+    // 1000000 = 0xF4240 -> c0 84 3d
+    std::string want = bytes({0x21, 0x02, 'a', 'b', 0xac, 0x02, 0xc0, 0x84, 0x3d});
+    CHECK(got == want, "fast sync bytes\n  got  %s\n  want %s", hex(got).c_str(), hex(want).c_str());
+}
+
+static void test_round_trips() {
+    std::vector<long> days;
+    for (int i = 0; i < 31; i++) days.push_back((i % 3 == 0) ? 0 : i * 517);
+    long buckets[12];
+    for (int i = 0; i < 12; i++) buckets[i] = i * 400;
+
+    DecodedPayload d;
+    CHECK(payload_decode(payload_month_share(2031, 12, 45, days, buckets), d), "month decode");
+    CHECK(d.kind == PAYLOAD_MONTH_SHARE && d.year == 2031 && d.month == 12 && d.goal_minutes == 45,
+          "month header %d %d-%d %d", d.kind, d.year, d.month, d.goal_minutes);
+    CHECK(d.day_minutes == minutes_of(days), "month days");
+    CHECK(d.bucket_minutes == minutes_of(std::vector<long>(buckets, buckets + 12)), "month buckets");
+
+    CHECK(payload_decode(payload_fast_sync("DEV-123", 4321, 98765), d), "fast sync decode");
+    CHECK(d.kind == PAYLOAD_FAST_SYNC && d.device_code == "DEV-123"
+          && d.today_seconds == 4321 && d.month_seconds == 98765, "fast sync fields");
+
+    // 闰年 366 天，有连续空白也有超过 127 分钟的日子
+    std::vector<long> year;
+    for (int i = 0; i < 366; i++) year.push_back((i / 30) % 2 ? 0 : (i * 97) % 20000);
+    CHECK(payload_decode(payload_year_share(2024, 30, year), d), "year decode");
+    CHECK(d.kind == PAYLOAD_YEAR_SHARE && d.year == 2024 && d.goal_minutes == 30, "year header");
+    CHECK(d.day_minutes == minutes_of(year), "year days");
+
+    // 起始日按本地日期换算，2024-01-01 距 1970-01-01 为 19723 天
+    struct tm tmv;
+    memset(&tmv, 0, sizeof(tmv));
+    tmv.tm_year = 2024 - 1900;
+    tmv.tm_mday = 1;
+    tmv.tm_isdst = -1;
+    time_t first = mktime(&tmv);
+    std::vector<long> history(1000, 0);
+    history[0] = 59;
+    history[999] = 86400;
+    CHECK(payload_decode(payload_history("k", first, history), d), "history decode");
+    CHECK(d.kind == PAYLOAD_HISTORY && d.device_code == "k" && d.first_epoch_day == 19723,
+          "history header %ld", d.first_epoch_day);
+    CHECK(d.day_minutes == minutes_of(history), "history days");
+}
+
+static void test_rejects() {
+    DecodedPayload d;
+    std::string good = payload_fast_sync("ab", 300, 1000000);
+    CHECK(payload_decode(good, d), "good input");
+    CHECK(!payload_decode("", d), "empty input");
+    CHECK(!payload_decode(good.substr(0, good.size() - 1), d), "truncated varint");
+    CHECK(!payload_decode(good + '\0', d), "trailing byte");
+
+    std::string future = good;
+    future[0] = (char)((PAYLOAD_FAST_SYNC << 4) | (PAYLOAD_VERSION + 1));
+    CHECK(!payload_decode(future, d), "unknown version");
+
+    std::string unknown = good;
+    unknown[0] = (char)((9 << 4) | PAYLOAD_VERSION);
+    CHECK(!payload_decode(unknown, d), "unknown kind");
+
+    // 位图声称的天数超过剩余字节
+    CHECK(!payload_decode(bytes({0x31, 0x01, 0x01, 0xff, 0x7f}), d), "oversized series");
+}
+
+int main() {
+    test_month_bytes();
+    test_fast_sync_bytes();
+    test_round_trips();
+    test_rejects();
+
+    return check_report();
+}
@@ -0,0 +1,333 @@
+#include <cairo.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "types.hpp"
+#include "utils.hpp"
+#include "dataprocess.hpp"
+#include "daily.hpp"
+#include "week.hpp"
+#include "month.hpp"
+#include "year.hpp"
+#include "payload.hpp"
+#include "qr.hpp"
+#include "render.hpp"
+#include "sharecard.hpp"
+
+// —— 离屏绘制基准与黄金图比对 ——
+// 构建机上运行的独立程序，不需要窗口：用固定的合成数据把各页图表画到 image surface，
+// 统计每页多次绘制的耗时；给出 GOLDEN_DIR 时再与其中的黄金 PNG 逐像素比对。
+//
+//   render-bench [GOLDEN_DIR] [--update-golden] [--gray] [--iterations N] [--size WxH]
+//                [--unbatched]
+//
+// --update-golden 把本次输出写为新的黄金图。有页面与黄金图不一致或缺少黄金图时返回 1。
+// --unbatched 让日历和热力图的格子逐个填充，对比按灰度批量填充前后的耗时。
+// 这种模式只计时，不比对黄金图：逐格填充在相邻同灰度格子的抗锯齿边缘会透出浅色接缝
+// (见 fill_rects_by_gray)，彩色模式下热力图与黄金图有细微差别
+
+// —— 合成数据 ——
+// 固定种子生成 2023-2024 两年的每日时长，结果在任何机器上都相同。
+// 查看的周选在过去，避免 "本周/这周" 文字随运行日期变化
+static const int FIXTURE_YEAR = 2024;
+static const int FIXTURE_MONTH = 5;
+static const int FIXTURE_WEEK_MONDAY = 13;     // 2024-05-13 是周一
+
+struct BenchFixture {
+    StatsRef stats;
+    ViewData view;
+    std::string share_url;
+};
+
+static time_t make_day(int year, int month, int day) {
+    struct tm tmv;
+    memset(&tmv, 0, sizeof(tmv));
+    tmv.tm_year = year - 1900;
+    tmv.tm_mon = month - 1;
+    tmv.tm_mday = day;
+    tmv.tm_isdst = -1;
+    return mktime(&tmv);
+}
+
+static void build_fixture(BenchFixture &fx) {
+    std::shared_ptr<Stats> s = std::make_shared<Stats>();
+    s->generation = 1;
+
+    unsigned int seed = 20240514u;
+    time_t day = make_day(FIXTURE_YEAR - 1, 1, 1);
+    time_t end = make_day(FIXTURE_YEAR + 1, 1, 1);
+    while (day < end) {
+        seed = seed * 1103515245u + 12345u;
+        long sec = (seed >> 8) % 7200;
+        // 大约五分之一的日子没有阅读
+        if ((seed >> 24) % 5 == 0) sec = 0;
+        s->history_map[day] = sec;
+        s->total_seconds += sec;
+        day = add_days(day, 1);
+    }
+    fx.stats = s;
+
+    ViewData &v = fx.view;
+    v = ViewData();
+
+    long buckets[12];
+    for (int i = 0; i < 12; i++) {
+        seed = seed * 1103515245u + 12345u;
+        buckets[i] = (i >= 3 && i <= 11) ? (long)((seed >> 8) % 3600) : 0;
+    }
+    set_daily_view_data(v, buckets);
+
+    time_t week_start = make_day(FIXTURE_YEAR, FIXTURE_MONTH, FIXTURE_WEEK_MONDAY);
+    long week[7];
+    compute_week_days(*s, week_start, week);
+    set_week_view_data(v, week_start, week);
+
+    std::vector<long> month;
+    compute_month_days(*s, FIXTURE_YEAR, FIXTURE_MONTH, month);
+    set_month_view_data(v, FIXTURE_YEAR, FIXTURE_MONTH, month, g_daily_target_minutes);
+
+    // 与分享链接同样长度和结构的内容
+    fx.share_url = "https://reading.tqhyg.net/s/?c="
+                 + base64url_encode(payload_month_share(FIXTURE_YEAR, FIXTURE_MONTH, 30, month, buckets));
+}
+
+// —— 各页绘制 ——
+typedef void (*BenchRenderFunc)(cairo_t *cr, const BenchFixture &fx, int w, int h);
+
+static void bench_today(cairo_t *cr, const BenchFixture &fx, int w, int h) {
+    render_today_dist(cr, fx.view, w, h);
+}
+
+static void bench_week(cairo_t *cr, const BenchFixture &fx, int w, int h) {
+    render_week_dist(cr, fx.view, w, h);
+}
+
+static void bench_month(cairo_t *cr, const BenchFixture &fx, int w, int h) {
+    render_month_view(cr, fx.view, w, h);
+}
+
+static void bench_year(cairo_t *cr, const BenchFixture &fx, int w, int h) {
+    render_year_view(cr, *fx.stats, FIXTURE_YEAR, w, h);
+}
+
+static void bench_qr(cairo_t *cr, const BenchFixture &fx, int w, int h) {
+    set_gray(cr, 1);
+    cairo_paint(cr);
+    QrRef qr = qr_encode(fx.share_url);
+    double side = std::min(w, h) * 0.8;
+    set_gray(cr, 0);
+    qr_paint(cr, *qr, (w - side) / 2, (h - side) / 2, side);
+}
+
+static void bench_card(cairo_t *cr, const BenchFixture &fx, int w, int h) {
+    ShareCardData d;
+    d.view = fx.view;
+    d.day = make_day(FIXTURE_YEAR, FIXTURE_MONTH, FIXTURE_WEEK_MONDAY);
+    d.target_minutes = g_daily_target_minutes;
+    d.share_url = fx.share_url;
+    render_share_card(cr, d, w, h);
+}
+
+struct BenchPage {
+    const char *name;
+    BenchRenderFunc render;
+};
+
+static const BenchPage BENCH_PAGES[] = {
+    {"today", bench_today},
+    {"week", bench_week},
+    {"month", bench_month},
+    {"year", bench_year},
+    {"qr", bench_qr},
+    {"card", bench_card},
+};
+
+// —— 计时与比对 ——
+static long long now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
+
+static cairo_surface_t* create_target(int w, int h) {
+    // 与图表缓存一致：灰度模式画在 A8 上
+    return cairo_image_surface_create(g_gray_render ? CAIRO_FORMAT_A8 : CAIRO_FORMAT_RGB24, w, h);
+}
+
+static long long render_once(const BenchPage &page, const BenchFixture &fx, cairo_surface_t *target) {
+    int w = cairo_image_surface_get_width(target);
+    int h = cairo_image_surface_get_height(target);
+
+    long long t0 = now_us();
+    cairo_t *cr = cairo_create(target);
+    if (g_gray_render) cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+    page.render(cr, fx, w, h);
+    cairo_destroy(cr);
+    cairo_surface_flush(target);
+    return now_us() - t0;
+}
+
+// A8 输出按屏幕效果 (白底印黑) 转成 RGB24，黄金图统一存成可直接查看的图片
+static cairo_surface_t* flatten(cairo_surface_t *src) {
+    int w = cairo_image_surface_get_width(src);
+    int h = cairo_image_surface_get_height(src);
+    cairo_surface_t *out = cairo_image_surface_create(CAIRO_FORMAT_RGB24, w, h);
+    cairo_t *cr = cairo_create(out);
+    if (cairo_image_surface_get_format(src) == CAIRO_FORMAT_A8) {
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_paint(cr);
+        cairo_set_source_rgb(cr, 0, 0, 0);
+        cairo_mask_surface(cr, src, 0, 0);
+    } else {
+        cairo_set_source_surface(cr, src, 0, 0);
+        cairo_paint(cr);
+    }
+    cairo_destroy(cr);
+    cairo_surface_flush(out);
+    return out;
+}
+
+// 像素在白底上的亮度 (0-255)，兼容读回的 PNG 带 alpha 的情况
+static int visible_gray(const unsigned char *px, cairo_format_t fmt) {
+    uint32_t v = *(const uint32_t *)px;
+    int a = (fmt == CAIRO_FORMAT_ARGB32) ? (int)(v >> 24) : 255;
+    int r = (v >> 16) & 0xFF, g = (v >> 8) & 0xFF, b = v & 0xFF;
+    // 预乘 alpha，叠到白底上
+    return (r + g + b) / 3 + (255 - a);
+}
+
+// 返回与黄金图不一致的像素数，尺寸不同或读取失败时返回 -1
+static long compare_golden(cairo_surface_t *out, const std::string &path) {
+    cairo_surface_t *golden = cairo_image_surface_create_from_png(path.c_str());
+    if (cairo_surface_status(golden) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(golden);
+        return -1;
+    }
+
+    int w = cairo_image_surface_get_width(out);
+    int h = cairo_image_surface_get_height(out);
+    cairo_format_t gfmt = cairo_image_surface_get_format(golden);
+    if (cairo_image_surface_get_width(golden) != w || cairo_image_surface_get_height(golden) != h
+        || (gfmt != CAIRO_FORMAT_RGB24 && gfmt != CAIRO_FORMAT_ARGB32)) {
+        cairo_surface_destroy(golden);
+        return -1;
+    }
+
+    const unsigned char *a = cairo_image_surface_get_data(out);
+    const unsigned char *b = cairo_image_surface_get_data(golden);
+    int sa = cairo_image_surface_get_stride(out);
+    int sb = cairo_image_surface_get_stride(golden);
+
+    // 字体栅格化在不同机器上可能有细微差别，亮度差在容差内视为相同
+    const int TOLERANCE = 16;
+    long diff = 0;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int ga = visible_gray(a + y * sa + x * 4, CAIRO_FORMAT_RGB24);
+            int gb = visible_gray(b + y * sb + x * 4, gfmt);
+            if (abs(ga - gb) > TOLERANCE) diff++;
+        }
+    }
+    cairo_surface_destroy(golden);
+    return diff;
+}
+
+static int run_render_bench(int argc, char **argv) {
+    std::string golden_dir;
+    bool update = false;
+    bool compare_off = false;
+    int iterations = 20;
+    int width = 1072, height = 1448;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--update-golden") == 0) {
+            update = true;
+        } else if (strcmp(argv[i], "--gray") == 0) {
+            g_gray_render = true;
+        } else if (strcmp(argv[i], "--unbatched") == 0) {
+            fill_rects_set_batched(false);
+            compare_off = true;
+        } else if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            sscanf(argv[++i], "%dx%d", &width, &height);
+        } else if (argv[i][0] != '-' && golden_dir.empty()) {
+            golden_dir = argv[i];
+        } else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    // 没有黄金图目录时只计时
+    bool timing_only = compare_off || golden_dir.empty();
+    if (iterations < 1 || width < 1 || height < 1 || (update && timing_only)) {
+        fprintf(stderr, "Usage: %s [GOLDEN_DIR] [--update-golden] [--gray] "
+                        "[--iterations N] [--size WxH] [--unbatched]\n", argv[0]);
+        return 2;
+    }
+    if (update) mkdir(golden_dir.c_str(), 0755);
+
+    BenchFixture fx;
+    build_fixture(fx);
+
+    printf("%-8s %10s %10s %10s  %s\n", "page", "cold(ms)", "mean(ms)", "min(ms)", "golden");
+
+    int failures = 0;
+    int missing = 0;
+    for (const BenchPage &page : BENCH_PAGES) {
+        cairo_surface_t *target = create_target(width, height);
+
+        // 首次绘制包含字形缓存、二维码编码等一次性开销，单独统计
+        long long cold = render_once(page, fx, target);
+        long long total = 0, best = -1;
+        for (int i = 0; i < iterations; i++) {
+            long long t = render_once(page, fx, target);
+            total += t;
+            if (best < 0 || t < best) best = t;
+        }
+
+        cairo_surface_t *out = flatten(target);
+        std::string path = golden_dir + "/" + page.name + (g_gray_render ? "-gray" : "") + ".png";
+        std::string status;
+        if (timing_only) {
+            status = "-";
+        } else if (update) {
+            status = cairo_surface_write_to_png(out, path.c_str()) == CAIRO_STATUS_SUCCESS
+                   ? "updated" : "write failed";
+        } else {
+            long diff = compare_golden(out, path);
+            if (diff < 0) {
+                status = "missing (run with --update-golden)";
+                missing++;
+            } else if (diff > 0) {
+                status = "MISMATCH: " + std::to_string(diff) + " px";
+                failures++;
+            } else {
+                status = "ok";
+            }
+        }
+
+        printf("%-8s %10.2f %10.2f %10.2f  %s\n", page.name,
+               cold / 1000.0, total / 1000.0 / iterations, best / 1000.0, status.c_str());
+
+        cairo_surface_destroy(out);
+        cairo_surface_destroy(target);
+    }
+
+    return (failures || missing) ? 1 : 0;
+}
+
+int main(int argc, char **argv) {
+    int rc = run_render_bench(argc, argv);
+    // test_env 建的临时数据目录，绘制用不到
+    rmdir(BASE_DIR.c_str());
+    return rc;
+}
@@ -0,0 +1,53 @@
+#include <cstdlib>
+#include <string>
+
+#include "types.hpp"
+
+// —— 测试用的全局定义 ——
+// 与 main.cpp 中的定义一一对应，数据目录换成每次运行新建的临时目录，测试之间互不影响
+
+static std::string make_test_dir() {
+    char tmpl[] = "/tmp/kykky-test-XXXXXX";
+    const char *dir = mkdtemp(tmpl);
+    return std::string(dir ? dir : "/tmp") + "/";
+}
+
+const std::string BASE_DIR = make_test_dir();
+
+const std::string LOG_DIR = BASE_DIR + "log/";
+const std::string ETC_ENABLE_FILE = BASE_DIR + "etc/enable";
+const std::string SETUP_SCRIPT = BASE_DIR + "bin/metrics_setup.sh";
+const std::string ARCHIVE_FILE = BASE_DIR + "log/history.gz";
+const std::string CONFIG_FILE = BASE_DIR + "etc/config.ini";
+const std::string ETC_TOKEN_FILE = BASE_DIR + "etc/token";
+const std::string STATE_FILE = BASE_DIR + "etc/state";
+const std::string SNAPSHOT_FILE = BASE_DIR + "etc/stats.snapshot";
+const std::string SHARE_CARD_DIR = BASE_DIR + "documents/";
+
+static const std::string s_temp_log = BASE_DIR + "history.log";
+const char *LOG_PREFIX = "metrics_reader_";
+const char *TEMP_LOG_FILE = s_temp_log.c_str();
+
+const int DEFAULT_TARGET_MINUTES = 30;
+const int MIN_TARGET_MINUTES = 10;
+const int MAX_TARGET_MINUTES = 180;
+const int DEFAULT_DETAIL_CACHE_KIB = 256;
+
+int g_daily_target_minutes = DEFAULT_TARGET_MINUTES;
+std::string g_share_domain = "reading.tqhyg.net";
+int g_detail_cache_kib = DEFAULT_DETAIL_CACHE_KIB;
+bool g_gray_render = false;
+
+GdkColor white = {0, 0xffff, 0xffff, 0xffff};
+GdkColor gray = {0, 0x8888, 0x8888, 0x8888};
+
+ViewData g_view_data;
+int g_view_year;
+int g_view_month;
+time_t g_view_daily_ts;
+time_t g_view_week_start;
+int g_view_heatmap_year;
+
+UIHandles g_ui_handles = {NULL, NULL};
+GtkWidget *g_notebook = NULL;
+DailyViewWidgets *g_daily_widgets = NULL;